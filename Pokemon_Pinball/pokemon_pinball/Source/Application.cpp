@@ -1,18 +1,35 @@
 
 #include "Module.h"
 #include "ModuleWindow.h"
+#include "ModuleInput.h"
 #include "ModuleRender.h"
 #include "ModuleAudio.h"
 #include "ModulePhysics.h"
 #include "ModuleGame.h"
 #include "ModuleFonts.h"
 #include "Application.h"
+#include "JobSystem.h"
+#include "AssetLoader.h"
+#include "Profiler.h"
+#include "Replay.h"
 
-Application::Application()
+Application::Application(bool headless) : headless(headless)
 {
-	window = new ModuleWindow(this);
-	renderer = new ModuleRender(this);
-	audio = new ModuleAudio(this, true);
+	window = NULL;
+	renderer = NULL;
+	jobs = new JobSystem();
+	assets = new AssetLoader(this);
+
+	if (headless == false)
+	{
+		window = new ModuleWindow(this);
+		renderer = new ModuleRender(this);
+	}
+
+	input = new ModuleInput(this);
+
+	// Headless keeps a disabled audio module, LoadFx/PlayFx are no-ops then
+	audio = new ModuleAudio(this, headless == false);
 	physics = new ModulePhysics(this);
 	scene_intro = new ModuleGame(this);
 	fontsModule = new ModuleFonts(this);
@@ -22,15 +39,16 @@ Application::Application()
 	// They will CleanUp() in reverse order
 
 	// Main Modules
-	AddModule(window);
-	AddModule(physics);
-	AddModule(audio);
+	if (headless == false) AddModule(window, "Window");
+	AddModule(input, "Input");
+	AddModule(physics, "Physics");
+	if (headless == false) AddModule(audio, "Audio");
 	
 	// Scenes
-	AddModule(scene_intro);
+	AddModule(scene_intro, "Game");
 
 	// Rendering happens at the end
-	AddModule(renderer);
+	if (headless == false) AddModule(renderer, "Render");
 }
 
 Application::~Application()
@@ -41,13 +59,20 @@ Application::~Application()
 		delete item;
 	}
 	list_modules.clear();
-	
+
+	// Not registered as a module when headless
+	if (headless == true) delete audio;
+
+	delete assets;
+	delete jobs;
 }
 
 bool Application::Init()
 {
 	bool ret = true;
 
+	jobs->Start(JOB_WORKERS);
+
 	// Call Init() in all modules
 	for (auto it = list_modules.begin(); it != list_modules.end() && ret; ++it)
 	{
@@ -63,6 +88,11 @@ bool Application::Init()
 		Module* module = *it;
 		ret = module->Start();
 	}
+
+	// Anything requested but never waited for
+	assets->Finish();
+
+	LOG("Application started in %.3f ms", startup_time.ReadMs());
 	
 	return ret;
 }
@@ -70,6 +100,31 @@ bool Application::Init()
 // Call PreUpdate, Update and PostUpdate on all modules
 update_status Application::Update()
 {
+	// F7 starts recording a replay, pressing it again writes it
+	if (IsKeyPressed(KEY_F7))
+	{
+		if (input->IsRecording())
+			input->StopRecording(REPLAY_FILE);
+		else
+			input->StartRecording();
+	}
+
+	// F2 starts a profiling session, pressing it again writes the trace
+	if (IsKeyPressed(KEY_F2))
+	{
+		if (Profiler::IsEnabled())
+		{
+			Profiler::SetEnabled(false);
+			Profiler::ExportChromeTrace(PROFILER_TRACE_FILE);
+		}
+		else
+		{
+			Profiler::SetEnabled(true);
+		}
+	}
+
+	PROFILE_SCOPE("Frame");
+	SCOPED_TIMER("Frame");
 	update_status ret = UPDATE_CONTINUE;
 
 	for (auto it = list_modules.begin(); it != list_modules.end() && ret == UPDATE_CONTINUE; ++it)
@@ -77,6 +132,7 @@ update_status Application::Update()
 		Module* module = *it;
 		if (module->IsEnabled())
 		{
+			PROFILE_SCOPE_CATEGORY(module->name, "PreUpdate");
 			ret = module->PreUpdate();
 		}
 	}
@@ -86,6 +142,7 @@ update_status Application::Update()
 		Module* module = *it;
 		if (module->IsEnabled())
 		{
+			PROFILE_SCOPE_CATEGORY(module->name, "Update");
 			ret = module->Update();
 		}
 	}
@@ -95,28 +152,77 @@ update_status Application::Update()
 		Module* module = *it;
 		if (module->IsEnabled())
 		{
+			PROFILE_SCOPE_CATEGORY(module->name, "PostUpdate");
 			ret = module->PostUpdate();
 		}
 	}
 
-	if (WindowShouldClose()) ret = UPDATE_STOP;
+	if (headless == false && WindowShouldClose()) ret = UPDATE_STOP;
 
 	return ret;
 }
 
+void Application::SaveSnapshot(std::vector<uint8>& snapshot)
+{
+	snapshot.clear();
+	physics->SaveState(snapshot);
+	scene_intro->SaveState(snapshot);
+	input->SaveState(snapshot);
+}
+
+bool Application::LoadSnapshot(const uint8* data, size_t size)
+{
+	// Physics checks its part before touching the world, but the game or input state after
+	// it can still be refused. Whatever was loaded by then is put back from the fallback
+	SaveSnapshot(fallback_snapshot);
+	if (LoadModuleStates(data, size))
+		return true;
+
+	LoadModuleStates(fallback_snapshot.data(), fallback_snapshot.size());
+	return false;
+}
+
+bool Application::LoadModuleStates(const uint8* data, size_t size)
+{
+	const uint8* in = data;
+	const uint8* end = data + size;
+
+	return physics->LoadState(in, end) && scene_intro->LoadState(in, end) && input->LoadState(in, end) && in == end;
+}
+
 bool Application::CleanUp()
 {
 	bool ret = true;
+
+	// A recording still running when the game closes is not lost
+	if (input->IsRecording())
+		input->StopRecording(REPLAY_FILE);
+
+	// The last ticks may still be stepping and calling into the game
+	physics->SetPipelined(false);
 	for (auto it = list_modules.rbegin(); it != list_modules.rend() && ret; ++it)
 	{
 		Module* item = *it;
 		ret = item->CleanUp();
 	}
+
+	// Modules may still have been waiting on jobs during their CleanUp
+	jobs->Stop();
+
+	TimerAccumulator::LogAll();
+
+	// Don't lose a session that was still running when closing
+	if (Profiler::IsEnabled())
+	{
+		Profiler::SetEnabled(false);
+		Profiler::ExportChromeTrace(PROFILER_TRACE_FILE);
+	}
 	
 	return ret;
 }
 
-void Application::AddModule(Module* mod)
+void Application::AddModule(Module* mod, const char* name)
 {
+	mod->name = name;
 	list_modules.emplace_back(mod);
 }
\ No newline at end of file
@@ -11,6 +11,9 @@ class ModuleAudio;
 class ModulePhysics;
 class ModuleGame;
 class ModuleFonts;
+class ModuleInput;
+class JobSystem;
+class AssetLoader;
 
 class Application
 {
@@ -18,12 +21,19 @@ public:
 
 	ModuleRender* renderer;
 	ModuleWindow* window;
+	ModuleInput* input;
 	ModuleAudio* audio;
 	ModulePhysics* physics;
 	ModuleGame* scene_intro;
 	ModuleGame* game;
 	ModuleFonts* fontsModule;
 
+	// Shared worker threads, any module can submit work from Init onwards
+	JobSystem* jobs;
+
+	// Startup textures and sounds, decoded on the job system
+	AssetLoader* assets;
+
 private:
 
 	std::vector<Module*> list_modules;
@@ -39,14 +49,28 @@ private:
 
 public:
 
-	Application();
+	// Headless runs physics and game logic only: no window, renderer or audio device
+	Application(bool headless = false);
 	~Application();
 
 	bool Init();
 	update_status Update();
 	bool CleanUp();
 
+	bool IsHeadless() const { return headless; }
+
+	// The whole simulation in a flat buffer: physics world, game and input state.
+	// Only between frames. Loading needs the same bodies and entities as when it
+	// was saved and continues bit for bit from there, false if they differ. A refused
+	// snapshot leaves everything as it was
+	void SaveSnapshot(std::vector<uint8>& snapshot);
+	bool LoadSnapshot(const uint8* data, size_t size);
+
 private:
 
-	void AddModule(Module* module);
+	void AddModule(Module* module, const char* name);
+	bool LoadModuleStates(const uint8* data, size_t size);
+
+	bool headless;
+	std::vector<uint8> fallback_snapshot;
 };
\ No newline at end of file
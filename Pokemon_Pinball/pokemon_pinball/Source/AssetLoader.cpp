@@ -0,0 +1,124 @@
+// ----------------------------------------------------
+// AssetLoader.cpp
+// Parallel image/wave decoding, upload on the main thread
+// ----------------------------------------------------
+
+#include "AssetLoader.h"
+#include "Application.h"
+#include "ModuleAudio.h"
+
+AssetLoader::AssetLoader(Application* app) : App(app)
+{}
+
+AssetLoader::~AssetLoader()
+{
+	// Too late to upload anything, just drop what was decoded
+	App->jobs->Wait(&pending);
+
+	for (AssetRequest* request : requests)
+	{
+		if (request->image.data != NULL) UnloadImage(request->image);
+		if (request->wave.data != NULL) UnloadWave(request->wave);
+		delete request;
+	}
+	requests.clear();
+}
+
+void AssetLoader::RequestTexture(const char* path, Texture2D* target)
+{
+	AssetRequest* request = Request(ASSET_TEXTURE, path, target);
+
+	App->jobs->Run([request]()
+	{
+		Timer timer;
+		request->image = LoadImage(request->path.c_str());
+		request->decode_ms = timer.ReadMs();
+	}, &pending);
+}
+
+void AssetLoader::RequestFx(const char* path, uint32* target)
+{
+	*target = 0;
+
+	// No device to upload to, don't bother decoding
+	if (App->audio->IsEnabled() == false)
+		return;
+
+	AssetRequest* request = Request(ASSET_FX, path, target);
+
+	App->jobs->Run([request]()
+	{
+		Timer timer;
+		request->wave = LoadWave(request->path.c_str());
+		request->decode_ms = timer.ReadMs();
+	}, &pending);
+}
+
+AssetLoader::AssetRequest* AssetLoader::Request(AssetType type, const char* path, void* target)
+{
+	if (requests.empty())
+		batch_timer.Start();
+
+	AssetRequest* request = new AssetRequest();
+	request->type = type;
+	request->path = path;
+	request->target = target;
+	request->image = Image{ 0 };
+	request->wave = Wave{ 0 };
+	request->decode_ms = 0.0;
+
+	requests.push_back(request);
+	return request;
+}
+
+void AssetLoader::Finish()
+{
+	if (requests.empty())
+		return;
+
+	App->jobs->Wait(&pending);
+	double decode_total_ms = 0.0;
+
+	// In request order, so sound ids come out the same as with serial loading
+	for (AssetRequest* request : requests)
+	{
+		Timer upload_timer;
+
+		if (request->type == ASSET_TEXTURE)
+		{
+			Texture2D* texture = (Texture2D*)request->target;
+			if (request->image.data != NULL)
+			{
+				*texture = LoadTextureFromImage(request->image);
+				UnloadImage(request->image);
+			}
+			else
+			{
+				*texture = Texture2D{ 0 };
+				LOG_WARNING("Cannot load texture: %s", request->path.c_str());
+			}
+		}
+		else
+		{
+			uint32* fx = (uint32*)request->target;
+			if (request->wave.data != NULL)
+			{
+				*fx = App->audio->LoadFx(request->wave, request->path.c_str());
+				UnloadWave(request->wave);
+			}
+			else
+			{
+				LOG_WARNING("Cannot load sound: %s", request->path.c_str());
+			}
+		}
+
+		LOG("Loaded %s: decode %.2f ms, upload %.2f ms", request->path.c_str(), request->decode_ms, upload_timer.ReadMs());
+		decode_total_ms += request->decode_ms;
+		delete request;
+	}
+
+	LOG("Loaded %d assets in %.2f ms (%.2f ms of decoding on %d workers)", (int)requests.size(),
+		batch_timer.ReadMs(), decode_total_ms, App->jobs->GetWorkerCount());
+
+	requests.clear();
+}
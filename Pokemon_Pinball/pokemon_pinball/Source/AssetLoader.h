@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Globals.h"
+#include "JobSystem.h"
+#include "Timer.h"
+
+#include <string>
+#include <vector>
+
+class Application;
+
+// Startup asset loading: Request* decodes the file on the job system right away,
+// Finish() waits for the decodes and uploads to the GPU / audio device on the
+// calling thread, which has to be the main thread
+class AssetLoader
+{
+public:
+
+	AssetLoader(Application* app);
+	~AssetLoader();
+
+	// target is written by Finish(), it must stay valid until then
+	void RequestTexture(const char* path, Texture2D* target);
+	void RequestFx(const char* path, uint32* target);
+
+	void Finish();
+
+private:
+
+	enum AssetType
+	{
+		ASSET_TEXTURE,
+		ASSET_FX
+	};
+
+	struct AssetRequest
+	{
+		AssetType type;
+		std::string path;
+		void* target;
+		Image image;
+		Wave wave;
+		double decode_ms;
+	};
+
+	AssetRequest* Request(AssetType type, const char* path, void* target);
+
+	Application* App;
+	std::vector<AssetRequest*> requests;
+	JobCounter pending;
+	Timer batch_timer;		// Since the first request of the batch
+};
@@ -0,0 +1,122 @@
+// ----------------------------------------------------
+// ChainSimplify.cpp
+// Load time simplification of collision outlines
+// ----------------------------------------------------
+
+#include "ChainSimplify.h"
+
+#include <float.h>
+
+static float PointSegmentDistanceSquared(const b2Vec2& p, const b2Vec2& a, const b2Vec2& b)
+{
+	b2Vec2 ab = b - a;
+	float length_sq = ab.LengthSquared();
+	float t = (length_sq > 0.0f) ? b2Clamp(b2Dot(p - a, ab) / length_sq, 0.0f, 1.0f) : 0.0f;
+
+	return b2DistanceSquared(p, a + t * ab);
+}
+
+static float Orientation(const b2Vec2& a, const b2Vec2& b, const b2Vec2& c)
+{
+	return b2Cross(b - a, c - a);
+}
+
+static float SegmentDistanceSquared(const b2Vec2& a1, const b2Vec2& a2, const b2Vec2& b1, const b2Vec2& b2)
+{
+	// Proper crossing, touching endpoints come out as 0 below anyway
+	float o1 = Orientation(a1, a2, b1);
+	float o2 = Orientation(a1, a2, b2);
+	float o3 = Orientation(b1, b2, a1);
+	float o4 = Orientation(b1, b2, a2);
+	if (((o1 > 0.0f && o2 < 0.0f) || (o1 < 0.0f && o2 > 0.0f)) && ((o3 > 0.0f && o4 < 0.0f) || (o3 < 0.0f && o4 > 0.0f)))
+		return 0.0f;
+
+	float d = PointSegmentDistanceSquared(a1, b1, b2);
+	d = b2Min(d, PointSegmentDistanceSquared(a2, b1, b2));
+	d = b2Min(d, PointSegmentDistanceSquared(b1, a1, a2));
+	d = b2Min(d, PointSegmentDistanceSquared(b2, a1, a2));
+	return d;
+}
+
+// Marks the vertices between first and last that must stay. Indices run past the
+// end of the loop so the last range can close on vertex 0
+static void SimplifyRange(const b2Vec2* vertices, int count, int first, int last, float tolerance_sq, std::vector<char>& keep)
+{
+	const b2Vec2& a = vertices[first % count];
+	const b2Vec2& b = vertices[last % count];
+
+	int farthest = -1;
+	float farthest_sq = tolerance_sq;
+	for (int i = first + 1; i < last; ++i)
+	{
+		float d = PointSegmentDistanceSquared(vertices[i % count], a, b);
+		if (d > farthest_sq)
+		{
+			farthest = i;
+			farthest_sq = d;
+		}
+	}
+
+	if (farthest < 0) return;
+
+	keep[farthest % count] = 1;
+	SimplifyRange(vertices, count, first, farthest, tolerance_sq, keep);
+	SimplifyRange(vertices, count, farthest, last, tolerance_sq, keep);
+}
+
+void SimplifyChainLoop(const b2Vec2* vertices, int count, float tolerance, std::vector<b2Vec2>& out)
+{
+	out.assign(vertices, vertices + count);
+	if (count <= 3 || tolerance <= 0.0f) return;
+
+	// A loop has no end points, split it at vertex 0 and the vertex farthest from it
+	int split = 0;
+	for (int i = 1; i < count; ++i)
+	{
+		if (b2DistanceSquared(vertices[0], vertices[i]) > b2DistanceSquared(vertices[0], vertices[split]))
+			split = i;
+	}
+
+	std::vector<char> keep(count, 0);
+	keep[0] = keep[split] = 1;
+	SimplifyRange(vertices, count, 0, split, tolerance * tolerance, keep);
+	SimplifyRange(vertices, count, split, count, tolerance * tolerance, keep);
+
+	std::vector<b2Vec2> simplified;
+	for (int i = 0; i < count; ++i)
+	{
+		if (keep[i]) simplified.push_back(vertices[i]);
+	}
+
+	if (simplified.size() >= 3) out.swap(simplified);
+}
+
+float ChainLoopDeviation(const b2Vec2* original, int original_count, const b2Vec2* simplified, int simplified_count)
+{
+	float deviation_sq = 0.0f;
+	for (int i = 0; i < original_count; ++i)
+	{
+		float d = FLT_MAX;
+		for (int j = 0; j < simplified_count; ++j)
+			d = b2Min(d, PointSegmentDistanceSquared(original[i], simplified[j], simplified[(j + 1) % simplified_count]));
+
+		deviation_sq = b2Max(deviation_sq, d);
+	}
+
+	return b2Sqrt(deviation_sq);
+}
+
+float ChainLoopDistance(const b2Vec2* a, int a_count, const b2Vec2* b, int b_count)
+{
+	float distance_sq = FLT_MAX;
+	for (int i = 0; i < a_count; ++i)
+	{
+		for (int j = 0; j < b_count; ++j)
+		{
+			distance_sq = b2Min(distance_sq, SegmentDistanceSquared(a[i], a[(i + 1) % a_count], b[j], b[(j + 1) % b_count]));
+			if (distance_sq == 0.0f) return 0.0f;
+		}
+	}
+
+	return b2Sqrt(distance_sq);
+}
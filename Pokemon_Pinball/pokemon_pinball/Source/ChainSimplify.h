@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Globals.h"
+
+#include "box2d/box2d.h"
+
+#include <vector>
+
+// Douglas-Peucker on a closed chain loop: keeps only the vertices needed for the
+// loop to stay within tolerance of the original outline. Nearly collinear points
+// and near duplicates both fall under the tolerance and are dropped.
+// out gets the original loop back when simplifying would leave less than 3 points
+void SimplifyChainLoop(const b2Vec2* vertices, int count, float tolerance, std::vector<b2Vec2>& out);
+
+// Farthest an original vertex lies from the simplified loop
+float ChainLoopDeviation(const b2Vec2* original, int original_count, const b2Vec2* simplified, int simplified_count);
+
+// Shortest distance between the edges of two closed loops, 0 when they cross
+float ChainLoopDistance(const b2Vec2* a, int a_count, const b2Vec2* b, int b_count);
@@ -0,0 +1,91 @@
+// ----------------------------------------------------
+// FlipperController.cpp
+// Kinematic flippers following an analytic swing profile
+// ----------------------------------------------------
+
+#include "FlipperController.h"
+
+#include <math.h>
+
+// Angle covered t seconds into a swing that starts at rest
+static float SwingTravel(float t, float acceleration, float top_speed)
+{
+	float ramp_time = top_speed / acceleration;
+	if (t <= ramp_time)
+		return 0.5f * acceleration * t * t;
+
+	return 0.5f * top_speed * ramp_time + top_speed * (t - ramp_time);
+}
+
+FlipperController::FlipperController()
+	: body(nullptr)
+	, pivot(b2Vec2_zero)
+	, arm(b2Vec2_zero)
+	, rest_angle(0.0f)
+	, active_angle(0.0f)
+	, active(false)
+	, swing_start_angle(0.0f)
+	, swing_time(0.0f)
+	, angle(0.0f)
+{}
+
+void FlipperController::Init(b2Body* _body, const b2Vec2& _pivot, const b2Vec2& _arm, float _rest_angle, float _active_angle)
+{
+	body = _body;
+	pivot = _pivot;
+	arm = _arm;
+	rest_angle = _rest_angle;
+	active_angle = _active_angle;
+
+	active = false;
+	swing_start_angle = angle = rest_angle;
+	swing_time = 0.0f;
+
+	body->SetTransform(PoseCenter(angle), angle);
+}
+
+void FlipperController::Drive(bool _active, float dt)
+{
+	// A press or release restarts the profile from wherever the flipper is
+	if (_active != active)
+	{
+		active = _active;
+		swing_start_angle = angle;
+		swing_time = 0.0f;
+	}
+
+	float target = active ? active_angle : rest_angle;
+	float distance = fabsf(target - swing_start_angle);
+	float next = target;
+
+	if (distance > 0.0f)
+	{
+		swing_time += dt;
+		float travel = active
+			? SwingTravel(swing_time, FLIPPER_UP_ACCELERATION, FLIPPER_UP_SPEED)
+			: SwingTravel(swing_time, FLIPPER_DOWN_ACCELERATION, FLIPPER_DOWN_SPEED);
+
+		if (travel < distance)
+			next = swing_start_angle + ((target > swing_start_angle) ? travel : -travel);
+	}
+
+	// Aim from the actual pose, rounding never accumulates over the swing
+	float inv_dt = 1.0f / dt;
+	body->SetLinearVelocity(inv_dt * (PoseCenter(next) - body->GetPosition()));
+	body->SetAngularVelocity(inv_dt * (next - body->GetAngle()));
+	angle = next;
+}
+
+// The body itself is restored with the world
+void FlipperController::SetSwing(const FlipperSwing& swing)
+{
+	active = swing.active;
+	swing_start_angle = swing.start_angle;
+	swing_time = swing.time;
+	angle = swing.angle;
+}
+
+b2Vec2 FlipperController::PoseCenter(float at_angle) const
+{
+	return pivot + b2Mul(b2Rot(at_angle), arm);
+}
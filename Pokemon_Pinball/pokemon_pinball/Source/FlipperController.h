@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Globals.h"
+
+#include "box2d/box2d.h"
+
+// Swing profile: constant angular acceleration up to a top speed, stopping dead at the end angle
+#define FLIPPER_UP_ACCELERATION		2000.0f	// rad/s^2 while the button is held
+#define FLIPPER_UP_SPEED			35.0f	// rad/s
+#define FLIPPER_DOWN_ACCELERATION	600.0f	// rad/s^2 falling back once released
+#define FLIPPER_DOWN_SPEED			15.0f	// rad/s
+
+// Where a swing is, enough to continue it after a snapshot restore
+struct FlipperSwing
+{
+	bool active;
+	float start_angle;
+	float time;
+	float angle;
+};
+
+// Drives a kinematic flipper body around its pivot without any joint. The angle
+// follows the swing profile in closed form from the last press or release, and the
+// body gets exactly the velocities that reach it by the end of the tick, so the
+// ball sees the real surface velocity of the flipper when they touch
+class FlipperController
+{
+public:
+	FlipperController();
+
+	// arm is the body origin relative to the pivot at angle 0, in meters.
+	// The body is moved to rest_angle right away
+	void Init(b2Body* body, const b2Vec2& pivot, const b2Vec2& arm, float rest_angle, float active_angle);
+
+	// Before every Step: velocities that take the body to the profile angle after dt
+	void Drive(bool active, float dt);
+
+	float GetAngle() const { return angle; }
+
+	FlipperSwing GetSwing() const { return { active, swing_start_angle, swing_time, angle }; }
+	void SetSwing(const FlipperSwing& swing);
+
+private:
+	b2Vec2 PoseCenter(float at_angle) const;
+
+	b2Body* body;
+	b2Vec2 pivot;
+	b2Vec2 arm;
+	float rest_angle;
+	float active_angle;
+
+	// Current swing, started from rest at swing_start_angle
+	bool active;
+	float swing_start_angle;
+	float swing_time;
+	float angle;
+};
@@ -2,11 +2,10 @@
 
 #include "raylib.h"
 
-#include <stdio.h>
-
-#define LOG(format, ...) log(__FILE__, __LINE__, format, __VA_ARGS__);
+#include "Log.h"
 
-void log(const char file[], int line, const char* format, ...);
+#include <stdio.h>
+#include <stdint.h>
 
 #define CAP(n) ((n <= 0.0f) ? n=0.0f : (n >= 1.0f) ? n=1.0f : n=n)
 
@@ -18,8 +17,9 @@ void log(const char file[], int line, const char* format, ...);
 #define TO_BOOL( a )  ( (a != 0) ? true : false )
 
 typedef unsigned int uint;
-typedef unsigned __int32 uint32;
-typedef unsigned __int64 uint64;
+typedef uint8_t uint8;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
 typedef unsigned char uchar;
 
 enum update_status
@@ -38,4 +38,22 @@ enum update_status
 #define WIN_BORDERLESS		false
 #define WIN_FULLSCREEN_DESKTOP false
 #define VSYNC				true
+#define PHYSICS_TICK_RATE	60		// Fixed simulation ticks per second
+#define PHYSICS_MAX_TICKS	5		// Max ticks per frame before dropping time (spiral of death clamp)
+#define PHYSICS_PIPELINED	true	// Step physics on its own thread while the frame renders
+#define PHYSICS_BAKE_PLAYFIELD	true	// Plain walls become fixtures of one static body instead of a dynamic body each
+#define PHYSICS_MAX_CONTACT_EVENTS	256	// Contacts buffered between dispatches, extra ones are dropped
+#define PHYSICS_CHAIN_TOLERANCE	1.0f	// Pixels a simplified wall outline may stray from the traced one, 0 keeps every vertex
+#define PHYSICS_BALL_BULLET	false	// Balls get continuous collision against flippers and other dynamic bodies too
+#define PHYSICS_TOI_BUDGET	0		// TOI sub-steps solved per world step, 0 = no limit
+#define PHYSICS_SUBSTEPS	1		// World steps per physics tick
+#define PHYSICS_VELOCITY_ITERATIONS	6	// Solver iterations per world step when they don't adapt
+#define PHYSICS_POSITION_ITERATIONS	2
+#define PHYSICS_ADAPTIVE_ITERATIONS	false	// Iterations follow ball speed and touching contacts each tick
+#define PHYSICS_PARALLEL_ISLANDS	false	// Independent islands of a world step are solved on the job system
+#define PHYSICS_WIDE_CONTACTS	false	// Contacts are solved several at a time with SIMD instead of one by one
+#define BALL_POOL_SIZE		8		// Pokeballs created at startup, the pool only grows past this many balls in play
+#define BALL_RADIUS			15		// Pixels
+#define JOB_WORKERS			0		// Job system threads, 0 = one per core besides the main thread
+#define LOG_FILE			"pinball.log"
 #define TITLE "Physics 2D Playground"
\ No newline at end of file
@@ -0,0 +1,679 @@
+// ----------------------------------------------------
+// HeadlessMain.cpp
+// Entry point of the headless build: runs ModulePhysics and
+// ModuleGame as fast as possible with scripted input and
+// reports simulated ticks per second.
+//
+// Usage: pinball_headless [-ticks N] [-script file] [-profile] [-pipelined] [-nobake] [-tolerance pixels] [-bullet] [-toibudget N] [-substeps N] [-adaptive] [-record file] [-replay file [-seek tick]] [-rollback N] [-parallel] [-workers N] [-ballbench N] [-solver default|wide|plain] [-solverbench N]
+// Script lines: "<tick> <key> <1|0>", "<tick> mouse <x> <y>" or "<tick> click <1|0>"
+// ----------------------------------------------------
+
+#include "Application.h"
+#include "Globals.h"
+#include "HeapStats.h"
+#include "JobSystem.h"
+#include "ModulePhysics.h"
+#include "ModuleGame.h"
+#include "NullBackend.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define DEFAULT_HEADLESS_TICKS 36000
+#define SCRIPT_MOUSE_MOVE -1
+#define SCRIPT_MOUSE_BUTTON -2
+
+struct ScriptEvent
+{
+	uint64 tick;
+	int key;		// SCRIPT_MOUSE_MOVE or SCRIPT_MOUSE_BUTTON for mouse events
+	int value;
+	int mouse_x;
+	int mouse_y;
+};
+
+static int KeyFromName(const char* name)
+{
+	struct KeyName { const char* name; int key; };
+	static const KeyName key_names[] = {
+		{ "A", KEY_A }, { "D", KEY_D }, { "S", KEY_S }, { "R", KEY_R },
+		{ "LEFT", KEY_LEFT }, { "RIGHT", KEY_RIGHT }, { "DOWN", KEY_DOWN },
+		{ "ONE", KEY_ONE }, { "TWO", KEY_TWO }, { "THREE", KEY_THREE },
+		{ "SPACE", KEY_SPACE }, { "F1", KEY_F1 }, { "F3", KEY_F3 }, { "F4", KEY_F4 },
+		{ "F5", KEY_F5 }, { "F6", KEY_F6 }
+	};
+
+	for (const KeyName& key_name : key_names)
+	{
+		if (strcmp(key_name.name, name) == 0) return key_name.key;
+	}
+	return -1;
+}
+
+static bool LoadScript(const char* path, std::vector<ScriptEvent>& events)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+	{
+		printf("Cannot open input script %s\n", path);
+		return false;
+	}
+
+	char line[256];
+	int line_number = 0;
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		++line_number;
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+		unsigned long long tick = 0;
+		char name[32];
+		int a = 0, b = 0;
+		int read = sscanf(line, "%llu %31s %d %d", &tick, name, &a, &b);
+
+		ScriptEvent ev = { (uint64)tick, SCRIPT_MOUSE_MOVE, 0, 0, 0 };
+		if (read == 4 && strcmp(name, "mouse") == 0)
+		{
+			ev.mouse_x = a;
+			ev.mouse_y = b;
+		}
+		else if (read >= 3 && strcmp(name, "click") == 0)
+		{
+			ev.key = SCRIPT_MOUSE_BUTTON;
+			ev.value = a;
+		}
+		else if (read >= 3 && (ev.key = KeyFromName(name)) >= 0)
+		{
+			ev.value = a;
+		}
+		else
+		{
+			printf("%s(%d) : ignoring malformed script line\n", path, line_number);
+			continue;
+		}
+		events.push_back(ev);
+	}
+
+	fclose(file);
+	return true;
+}
+
+// Built-in soak pattern when no script is given: launch, flip both pads regularly
+// and restart after a game over
+static void AutoPlay(uint64 tick)
+{
+	NullBackendSetKey(KEY_S, (tick % 600) < 45);
+	NullBackendSetKey(KEY_A, (tick % 40) < 8);
+	NullBackendSetKey(KEY_D, ((tick + 20) % 40) < 8);
+	NullBackendSetKey(KEY_R, (tick % 1200) == 0);
+}
+
+// Only the flippers: a restart would add bodies the snapshot does not have
+static void BenchPlay(uint64 tick)
+{
+	NullBackendSetKey(KEY_A, (tick % 40) < 8);
+	NullBackendSetKey(KEY_D, ((tick + 20) % 40) < 8);
+}
+
+// Drained balls come back on a grid over the table, so the count holds during a pass.
+// Lives are topped up too: after a game over every ball drains on its first contact
+static void BenchRefill(Application* App, int balls)
+{
+	App->scene_intro->lives = 3;
+	App->scene_intro->gameOver = false;
+
+	int spawned = 0;
+	while ((int)App->physics->GetCircles(POKEBALL).size() < balls)
+	{
+		App->scene_intro->SpawnBall(120 + (spawned % 8) * 50, 150 + ((spawned / 8) % 8) * 60);
+		++spawned;
+	}
+}
+
+static const char* solver_names[] = { "default", "wide", "plain" };
+
+static int SolverFromName(const char* name)
+{
+	for (int i = 0; i < (int)(sizeof(solver_names) / sizeof(solver_names[0])); ++i)
+		if (strcmp(name, solver_names[i]) == 0) return i;
+	return -1;
+}
+
+// One way of stepping the same ticks, see RunBenchPasses
+struct BenchPass
+{
+	bool parallel;
+	b2ContactSolverMode solver;
+	double step_us;			// World step and its velocity solve, per tick
+	double velocity_us;
+	std::vector<uint32> hashes;
+};
+
+struct BenchCounts
+{
+	double islands;		// Per tick, over all passes
+	double touching;
+};
+
+// Warms up with balls in play, snapshots and runs every pass from that snapshot.
+// False when the world kept changing and could not be restored
+static bool RunBenchPasses(Application* App, int balls, BenchPass* passes, int pass_count, uint64& tick, double tick_dt, BenchCounts& counts)
+{
+	const int warmup_ticks = 60;
+	const int pass_ticks = 600;
+
+	b2World* world = App->physics->GetWorld();
+	std::vector<uint8> snapshot;
+
+	App->physics->SetParallelIslands(passes[0].parallel);
+	App->physics->SetContactSolver(passes[0].solver);
+	for (int i = 0; i < warmup_ticks; ++i, ++tick)
+	{
+		BenchRefill(App, balls);
+		NullBackendNewFrame(tick_dt);
+		BenchPlay(tick);
+		App->Update();
+	}
+
+	// A pass that grew the world (the ball pool, the first Latios) cannot be restored
+	// for the next one, all passes then run again from a snapshot of the grown world
+	for (int attempt = 0; attempt < 3; ++attempt)
+	{
+		App->SaveSnapshot(snapshot);
+		counts = {};
+
+		bool restored = true;
+		for (int pass = 0; pass < pass_count && restored; ++pass)
+		{
+			BenchPass& bench = passes[pass];
+			if (pass > 0 && App->LoadSnapshot(snapshot.data(), snapshot.size()) == false)
+			{
+				restored = false;
+				break;
+			}
+
+			App->physics->SetParallelIslands(bench.parallel);
+			App->physics->SetContactSolver(bench.solver);
+			App->physics->TakeTickHashes(bench.hashes);
+			bench.hashes.clear();
+
+			double step_ms = 0.0, velocity_ms = 0.0;
+			for (int i = 0; i < pass_ticks; ++i)
+			{
+				BenchRefill(App, balls);
+				NullBackendNewFrame(tick_dt);
+				BenchPlay(tick + i);
+				App->Update();
+
+				const b2Profile& profile = world->GetProfile();
+				step_ms += profile.step;
+				velocity_ms += profile.solveVelocity;
+				counts.islands += world->GetIslandCount();
+				counts.touching += App->physics->GetWorldStats().touching_contacts;
+			}
+
+			App->physics->TakeTickHashes(bench.hashes);
+			bench.step_us = 1000.0 * step_ms / pass_ticks;
+			bench.velocity_us = 1000.0 * velocity_ms / pass_ticks;
+		}
+		tick += pass_ticks;
+
+		if (restored)
+		{
+			counts.islands /= pass_count * pass_ticks;
+			counts.touching /= pass_count * pass_ticks;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Step time against ball count. Every count runs from the same snapshot with islands
+// solved serially and then on the job system, the world hashes of both passes must match
+static void RunBallBenchmark(Application* App, int max_balls, double tick_dt)
+{
+	bool parallel = App->physics->IsParallelIslands();
+	b2ContactSolverMode solver = App->physics->GetContactSolver();
+	BenchPass passes[2] = {};
+	passes[0].solver = passes[1].solver = solver;
+	passes[1].parallel = true;
+	uint64 tick = 0;
+
+	printf("Island benchmark: %d tasks, %s contact solver, 600 ticks per pass\n", App->physics->GetTaskCount(), solver_names[solver]);
+	printf("  balls  islands  serial us/step  parallel us/step  speedup  hashes\n");
+
+	// Growing the ball pool warns once per ball
+	LogSetConsoleLevel(LOG_LEVEL_ERROR);
+	App->physics->SetTickHashing(true);
+
+	for (int balls = 1; balls <= max_balls; balls *= 2)
+	{
+		BenchCounts counts;
+		if (RunBenchPasses(App, balls, passes, 2, tick, tick_dt, counts) == false)
+		{
+			printf("  %5d  the world kept changing, skipped\n", balls);
+			continue;
+		}
+
+		printf("  %5d  %7.1f  %14.1f  %16.1f  %6.2fx  %s\n", balls, counts.islands, passes[0].step_us, passes[1].step_us,
+			passes[0].step_us / passes[1].step_us, (passes[0].hashes == passes[1].hashes) ? "match" : "DIFFER");
+	}
+
+	App->physics->SetTickHashing(false);
+	App->physics->SetParallelIslands(parallel);
+	LogSetConsoleLevel(LOG_LEVEL_WARNING);
+}
+
+// The table rarely keeps more than a few contacts per island. Balls settled in a pit are
+// one island with a couple of contacts each, where batches fill up. Sleep is off so the
+// pile keeps solving, bodies holds the final transforms to compare solvers by.
+// Returns the contacts touching at the end
+static int RunPitPass(int balls, b2ContactSolverMode mode, std::vector<float>& bodies, double& step_us, double& velocity_us)
+{
+	const int settle_steps = 120;
+	const int measured_steps = 480;
+	const float radius = 0.25f;
+	const int columns = 16;
+
+	b2World pit(b2Vec2(0.0f, -10.0f));
+	pit.SetAllowSleeping(false);
+	pit.SetContactSolver(mode);
+
+	b2BodyDef ground_def;
+	b2Body* ground = pit.CreateBody(&ground_def);
+	b2Vec2 walls[4] = { b2Vec2(0.0f, 100.0f), b2Vec2(0.0f, 0.0f), b2Vec2(columns * 2.0f * radius, 0.0f), b2Vec2(columns * 2.0f * radius, 100.0f) };
+	b2ChainShape chain;
+	chain.CreateChain(walls, 4, walls[0], walls[3]);
+	ground->CreateFixture(&chain, 0.0f);
+
+	b2CircleShape circle;
+	circle.m_radius = radius;
+	b2BodyDef ball_def;
+	ball_def.type = b2_dynamicBody;
+	for (int i = 0; i < balls; ++i)
+	{
+		// Every other row is shifted so the pile does not stand in columns
+		int row = i / columns;
+		ball_def.position.Set(radius * (2 * (i % columns) + 1 + (row & 1) * 0.5f), radius * (2.2f * row + 1.0f));
+		pit.CreateBody(&ball_def)->CreateFixture(&circle, 1.0f);
+	}
+
+	double step_ms = 0.0, velocity_ms = 0.0;
+	for (int i = 0; i < settle_steps + measured_steps; ++i)
+	{
+		pit.Step(1.0f / 60.0f, PHYSICS_VELOCITY_ITERATIONS, PHYSICS_POSITION_ITERATIONS);
+		if (i < settle_steps) continue;
+
+		step_ms += pit.GetProfile().step;
+		velocity_ms += pit.GetProfile().solveVelocity;
+	}
+
+	bodies.clear();
+	for (const b2Body* b = pit.GetBodyList(); b; b = b->GetNext())
+	{
+		bodies.push_back(b->GetPosition().x);
+		bodies.push_back(b->GetPosition().y);
+		bodies.push_back(b->GetAngle());
+	}
+
+	step_us = 1000.0 * step_ms / measured_steps;
+	velocity_us = 1000.0 * velocity_ms / measured_steps;
+
+	int touching = 0;
+	for (const b2Contact* c = pit.GetContactList(); c; c = c->GetNext())
+	{
+		if (c->IsTouching())
+			++touching;
+	}
+	return touching;
+}
+
+// Contact solve time against ball count, from the same snapshot with the default solver,
+// the wide one and the wide batches without SIMD. Wide and plain must hash the same
+static void RunSolverBenchmark(Application* App, int max_balls, double tick_dt)
+{
+	b2ContactSolverMode solver = App->physics->GetContactSolver();
+	BenchPass passes[3] = {};
+	passes[0].parallel = passes[1].parallel = passes[2].parallel = App->physics->IsParallelIslands();
+	passes[0].solver = b2_contactSolverDefault;
+	passes[1].solver = b2_contactSolverWide;
+	passes[2].solver = b2_contactSolverWidePlain;
+	uint64 tick = 0;
+
+	printf("Contact solver benchmark: %d lanes of %s, islands solved %s, 600 ticks per pass\n", b2GetWideContactLanes(),
+		b2GetWideContactInstructions(), passes[0].parallel ? "in parallel" : "serially");
+	printf("  balls  touching  default us/step (velocity)  wide us/step (velocity)  plain velocity us  velocity speedup  wide vs plain\n");
+
+	LogSetConsoleLevel(LOG_LEVEL_ERROR);
+	App->physics->SetTickHashing(true);
+
+	for (int balls = 1; balls <= max_balls; balls *= 2)
+	{
+		BenchCounts counts;
+		if (RunBenchPasses(App, balls, passes, 3, tick, tick_dt, counts) == false)
+		{
+			printf("  %5d  the world kept changing, skipped\n", balls);
+			continue;
+		}
+
+		printf("  %5d  %8.1f  %15.1f (%7.1f)  %12.1f (%7.1f)  %17.1f  %15.2fx  %s\n", balls, counts.touching,
+			passes[0].step_us, passes[0].velocity_us, passes[1].step_us, passes[1].velocity_us, passes[2].velocity_us,
+			passes[0].velocity_us / passes[1].velocity_us, (passes[1].hashes == passes[2].hashes) ? "match" : "DIFFER");
+	}
+
+	printf("Ball pit, one island\n");
+	printf("  balls  contacts  default us/step (velocity)  wide us/step (velocity)  plain velocity us  velocity speedup  wide vs plain\n");
+
+	std::vector<float> bodies[3];
+	for (int balls = 16; balls <= 16 * max_balls; balls *= 2)
+	{
+		double step_us[3], velocity_us[3];
+		int pit_contacts = 0;
+		for (int pass = 0; pass < 3; ++pass)
+			pit_contacts = RunPitPass(balls, passes[pass].solver, bodies[pass], step_us[pass], velocity_us[pass]);
+
+		printf("  %5d  %8d  %15.1f (%7.1f)  %12.1f (%7.1f)  %17.1f  %15.2fx  %s\n", balls, pit_contacts, step_us[0], velocity_us[0],
+			step_us[1], velocity_us[1], velocity_us[2], velocity_us[0] / velocity_us[1], (bodies[1] == bodies[2]) ? "match" : "DIFFER");
+	}
+
+	App->physics->SetTickHashing(false);
+	App->physics->SetContactSolver(solver);
+	LogSetConsoleLevel(LOG_LEVEL_WARNING);
+}
+
+int main(int argc, char** argv)
+{
+	uint64 total_ticks = DEFAULT_HEADLESS_TICKS;
+	const char* script_path = NULL;
+	bool profile = false;
+	bool pipelined = false;
+	bool bake = true;
+	float tolerance = PHYSICS_CHAIN_TOLERANCE;
+	bool bullet = PHYSICS_BALL_BULLET;
+	int toi_budget = PHYSICS_TOI_BUDGET;
+	int substeps = PHYSICS_SUBSTEPS;
+	bool adaptive = PHYSICS_ADAPTIVE_ITERATIONS;
+	const char* record_path = NULL;
+	const char* replay_path = NULL;
+	uint64 seek_tick = 0;
+	uint64 rollback_interval = 0;
+	bool parallel = PHYSICS_PARALLEL_ISLANDS;
+	int workers = JOB_WORKERS;
+	int ball_bench = 0;
+	int solver = PHYSICS_WIDE_CONTACTS ? b2_contactSolverWide : b2_contactSolverDefault;
+	int solver_bench = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc) total_ticks = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "-script") == 0 && i + 1 < argc) script_path = argv[++i];
+		else if (strcmp(argv[i], "-profile") == 0) profile = true;
+		else if (strcmp(argv[i], "-pipelined") == 0) pipelined = true;
+		else if (strcmp(argv[i], "-nobake") == 0) bake = false;
+		else if (strcmp(argv[i], "-tolerance") == 0 && i + 1 < argc) tolerance = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "-bullet") == 0) bullet = true;
+		else if (strcmp(argv[i], "-toibudget") == 0 && i + 1 < argc) toi_budget = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-substeps") == 0 && i + 1 < argc) substeps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-adaptive") == 0) adaptive = true;
+		else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc) record_path = argv[++i];
+		else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc) replay_path = argv[++i];
+		else if (strcmp(argv[i], "-seek") == 0 && i + 1 < argc) seek_tick = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "-rollback") == 0 && i + 1 < argc) rollback_interval = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "-parallel") == 0) parallel = true;
+		else if (strcmp(argv[i], "-workers") == 0 && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-ballbench") == 0 && i + 1 < argc) ball_bench = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-solver") == 0 && i + 1 < argc && SolverFromName(argv[i + 1]) >= 0) solver = SolverFromName(argv[++i]);
+		else if (strcmp(argv[i], "-solverbench") == 0 && i + 1 < argc) solver_bench = atoi(argv[++i]);
+		else
+		{
+			printf("Usage: %s [-ticks N] [-script file] [-profile] [-pipelined] [-nobake] [-tolerance pixels] [-bullet] [-toibudget N] [-substeps N] [-adaptive] [-record file] [-replay file [-seek tick]] [-rollback N] [-parallel] [-workers N] [-ballbench N] [-solver default|wide|plain] [-solverbench N]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Rolling back rewinds the built-in pattern, it has no state of its own, and needs the tick hashes to itself
+	if (rollback_interval > 0 && (script_path != NULL || record_path != NULL || replay_path != NULL))
+	{
+		printf("-rollback only runs the built-in pattern, without -script, -record or -replay\n");
+		return EXIT_FAILURE;
+	}
+
+	if ((ball_bench > 0 || solver_bench > 0) && (script_path != NULL || record_path != NULL || replay_path != NULL || rollback_interval > 0))
+	{
+		printf("-ballbench and -solverbench run on their own, without -script, -record, -replay or -rollback\n");
+		return EXIT_FAILURE;
+	}
+
+	std::vector<ScriptEvent> script;
+	if (script_path != NULL && LoadScript(script_path, script) == false) return EXIT_FAILURE;
+
+	// Keep stdout for the report, the full log goes to the file
+	LogStart("pinball_headless.log");
+	LogSetConsoleLevel(LOG_LEVEL_WARNING);
+
+	// A replay runs with the settings it was recorded with, whatever the command line says
+	ReplayReader replay;
+	if (replay_path != NULL)
+	{
+		if (replay.Load(replay_path) == false)
+		{
+			printf("Cannot load replay %s\n", replay_path);
+			LogStop();
+			return EXIT_FAILURE;
+		}
+
+		const ReplaySettings& settings = replay.GetSettings();
+		bake = settings.bake_playfield;
+		tolerance = settings.chain_tolerance;
+		bullet = settings.ball_bullet;
+		toi_budget = settings.toi_budget;
+		substeps = settings.substeps;
+		adaptive = settings.adaptive_iterations;
+		solver = settings.contact_solver;
+		total_ticks = replay.GetFrameCount();
+	}
+
+	Application* App = new Application(true);
+	if (replay_path != NULL) App->physics->SetTickRate(replay.GetSettings().tick_rate);
+
+	// Without baking every wall is a dynamic body of its own, to compare against
+	if (bake == false) App->physics->SetPlayfieldBaking(false);
+	App->physics->SetChainTolerance(tolerance);
+	App->physics->SetBallBullet(bullet);
+	App->physics->SetTOIBudget(toi_budget);
+	App->physics->SetSubSteps(substeps);
+	App->physics->SetAdaptiveIterations(adaptive);
+	App->physics->SetParallelIslands(parallel);
+	App->physics->SetContactSolver((b2ContactSolverMode)solver);
+
+	// Started before Init, which then keeps this worker count
+	App->jobs->Start(workers);
+
+	if (App->Init() == false)
+	{
+		printf("Application Init exits with ERROR\n");
+		delete App;
+		LogStop();
+		return EXIT_FAILURE;
+	}
+
+	if (ball_bench > 0 || solver_bench > 0)
+	{
+		if (ball_bench > 0) RunBallBenchmark(App, ball_bench, 1.0 / App->physics->GetTickRate());
+		if (solver_bench > 0) RunSolverBenchmark(App, solver_bench, 1.0 / App->physics->GetTickRate());
+
+		int ret = (App->CleanUp() == true) ? EXIT_SUCCESS : EXIT_FAILURE;
+		delete App;
+		LogStop();
+		return ret;
+	}
+
+	// Exercises the physics thread hand-off, there is no rendering to overlap here
+	if (pipelined) App->physics->SetPipelined(true);
+
+	if (record_path != NULL) App->input->StartRecording();
+	if (replay_path != NULL)
+	{
+		App->input->StartReplay(&replay);
+
+		if (seek_tick > 0)
+		{
+			Timer seek_timer;
+			bool found = App->input->SeekReplay(seek_tick);
+			printf("Seek to tick %llu: %s in %.3f ms\n", (unsigned long long)seek_tick,
+				found ? "restored the keyframe before it" : "no keyframe", seek_timer.ReadMs());
+		}
+	}
+
+	PhysicsWorldStats start_stats = App->physics->GetWorldStats();
+	PhysicsChainStats chain_stats = App->physics->GetChainStats();
+
+	double tick_dt = 1.0 / App->physics->GetTickRate();
+	size_t next_event = 0;
+	uint64 tick = 0;
+
+	// Only the last PROFILER_MAX_EVENTS zones survive, enough for the end of a long run
+	if (profile) Profiler::SetEnabled(true);
+
+	// Rollback: every segment of rollback_interval ticks runs twice from a snapshot taken at its start
+	std::vector<uint8> snapshot;
+	std::vector<uint32> first_pass, second_pass;
+	bool rolled_back = false;
+	int rollback_segments = 0, rollback_mismatches = 0, rollback_saves = 0, rollback_skipped = 0;
+	double save_ms = 0.0, load_ms = 0.0;
+	if (rollback_interval > 0) App->physics->SetTickHashing(true);
+
+	Timer run_timer;
+	uint64 run_allocations = GetHeapAllocations();
+
+	for (; tick < total_ticks && App->input->IsReplayFinished() == false; ++tick)
+	{
+		if (rollback_interval > 0 && (tick % rollback_interval) == 0)
+		{
+			if (rolled_back)
+			{
+				App->physics->TakeTickHashes(second_pass);
+				if (second_pass != first_pass) ++rollback_mismatches;
+				++rollback_segments;
+				rolled_back = false;
+			}
+			else if (tick > 0)
+			{
+				App->physics->TakeTickHashes(first_pass);
+
+				// Bodies created since the snapshot (a new Latios) make it useless, start a new segment
+				Timer load_timer;
+				if (App->LoadSnapshot(snapshot.data(), snapshot.size()))
+				{
+					load_ms += load_timer.ReadMs();
+					tick -= rollback_interval;
+					rolled_back = true;
+				}
+				else
+				{
+					++rollback_skipped;
+				}
+			}
+
+			if (rolled_back == false)
+			{
+				first_pass.clear();
+				second_pass.clear();
+
+				Timer save_timer;
+				App->SaveSnapshot(snapshot);
+				save_ms += save_timer.ReadMs();
+				++rollback_saves;
+			}
+		}
+
+		NullBackendNewFrame(tick_dt);
+
+		// Replayed frames ignore the keyboard anyway
+		if (script_path == NULL && App->input->IsReplaying() == false) AutoPlay(tick);
+
+		while (next_event < script.size() && script[next_event].tick <= tick)
+		{
+			const ScriptEvent& ev = script[next_event++];
+			if (ev.key == SCRIPT_MOUSE_MOVE) NullBackendSetMousePosition(ev.mouse_x, ev.mouse_y);
+			else if (ev.key == SCRIPT_MOUSE_BUTTON) NullBackendSetMouseButton(MOUSE_BUTTON_LEFT, ev.value != 0);
+			else NullBackendSetKey(ev.key, ev.value != 0);
+		}
+
+		if (App->Update() != UPDATE_CONTINUE) break;
+	}
+
+	double seconds = run_timer.ReadSec();
+	run_allocations = GetHeapAllocations() - run_allocations;
+
+	printf("Simulated %llu ticks (%.1f s of game time) in %.3f s\n", (unsigned long long)tick, tick * tick_dt, seconds);
+	printf("%.0f ticks/s, %.1fx real time\n", tick / seconds, (tick * tick_dt) / seconds);
+	printf("Score %d, lives %d, entities %d, balls in play %d\n", App->scene_intro->suma, App->scene_intro->lives,
+		(int)App->scene_intro->entities.size(), (int)App->physics->GetCircles(POKEBALL).size());
+	printf("Heap allocations %llu, %d ball spawns and %d drains made %llu of them (pool of %d)\n",
+		(unsigned long long)run_allocations, App->scene_intro->ball_spawns, App->scene_intro->ball_drains,
+		(unsigned long long)App->scene_intro->ball_allocations, (int)App->scene_intro->balls.size());
+
+	printf("Chains: %d loops, %d edges traced, %d simplified at %.2f px (%.2f px off at most)\n", chain_stats.chains,
+		chain_stats.edges_before, chain_stats.edges_after, tolerance, chain_stats.max_deviation);
+
+	const PhysicsTunnelingStats& tunneling = App->physics->GetTunnelingStats();
+	printf("CCD: bullet balls %s, TOI budget %d: %llu TOI events, %llu sub-steps (%d max per step), %llu steps over budget (%llu bodies held), %llu wall penetrations\n",
+		bullet ? "on" : "off", toi_budget, (unsigned long long)tunneling.toi_events, (unsigned long long)tunneling.toi_substeps,
+		tunneling.max_substeps, (unsigned long long)tunneling.budget_ticks, (unsigned long long)tunneling.held_bodies,
+		(unsigned long long)tunneling.wall_penetrations);
+
+	const PhysicsBudgetStats& budget = App->physics->GetBudgetStats();
+	if (budget.ticks > 0)
+	{
+		printf("Solver: %d sub-steps per tick, iterations %s: %.2f velocity and %.2f position per tick, %.1f%% of ticks at the top budget\n",
+			App->physics->GetSubSteps(), adaptive ? "adaptive" : "fixed", (double)budget.velocity_iterations / budget.ticks,
+			(double)budget.position_iterations / budget.ticks, 100.0 * budget.top_budget_ticks / budget.ticks);
+	}
+
+	if (rollback_interval > 0 && rollback_segments > 0)
+	{
+		printf("Rollback: %d segments of %llu ticks rerun from a snapshot, %d differed, %d skipped. %d byte snapshot, %.1f us to save, %.1f us to restore\n",
+			rollback_segments, (unsigned long long)rollback_interval, rollback_mismatches, rollback_skipped, (int)snapshot.size(),
+			1000.0 * save_ms / rollback_saves, 1000.0 * load_ms / rollback_segments);
+	}
+
+	if (record_path != NULL)
+	{
+		App->input->StopRecording(record_path);
+		printf("Recorded %llu ticks to %s\n", (unsigned long long)App->physics->GetNextTick(), record_path);
+	}
+	if (replay_path != NULL)
+	{
+		if (App->input->GetFirstDivergentTick() < 0)
+			printf("Replay matched all %llu checked ticks, %d bytes of input for %llu frames\n", (unsigned long long)App->input->GetCheckedTicks(),
+				(int)replay.GetEncodedSize(), (unsigned long long)replay.GetFrameCount());
+		else
+			printf("Replay diverged at tick %lld\n", (long long)App->input->GetFirstDivergentTick());
+	}
+
+	PhysicsWorldStats end_stats = App->physics->GetWorldStats();
+	printf("World at start: %d bodies, %d joints, %d proxies, %d contacts (%d touching)\n", start_stats.bodies,
+		start_stats.joints, start_stats.proxies, start_stats.contacts, start_stats.touching_contacts);
+	printf("World at end:   %d bodies (%d awake), %d proxies, %d contacts (%d touching), %d islands solved %s, %s contact solver\n", end_stats.bodies,
+		end_stats.awake_bodies, end_stats.proxies, end_stats.contacts, end_stats.touching_contacts, end_stats.islands,
+		App->physics->IsParallelIslands() ? "in parallel" : "serially", solver_names[App->physics->GetContactSolver()]);
+
+	for (int i = 0; i < TimerAccumulator::Count(); ++i)
+	{
+		const TimerAccumulator& acc = TimerAccumulator::At(i);
+		printf("  %-16s %10llu calls %10.2f us avg %10.2f us max\n", acc.name,
+			(unsigned long long)acc.calls.load(), acc.AverageUs(), acc.MaxUs());
+	}
+
+	int ret = (App->CleanUp() == true) ? EXIT_SUCCESS : EXIT_FAILURE;
+	delete App;
+	LogStop();
+
+	return ret;
+}
@@ -0,0 +1,87 @@
+// ----------------------------------------------------
+// HeapStats.cpp
+// Replaces the global operator new/delete to count allocations.
+// Only with HEAP_STATS, set by the headless build: the game
+// would pay an atomic add per allocation for a number it never reads
+// ----------------------------------------------------
+
+#include "HeapStats.h"
+
+#ifdef HEAP_STATS
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<uint64> heap_allocations(0);
+
+uint64 GetHeapAllocations()
+{
+	return heap_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* ptr = malloc(size > 0 ? size : 1);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+#else
+
+uint64 GetHeapAllocations()
+{
+	return 0;
+}
+
+#endif
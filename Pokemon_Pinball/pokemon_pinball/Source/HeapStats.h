@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Globals.h"
+
+// Calls to the global operator new since startup, from any thread.
+// Read it before and after a piece of code to count what it allocated.
+// Always 0 unless built with HEAP_STATS, like pinball_headless is.
+uint64 GetHeapAllocations();
@@ -0,0 +1,234 @@
+// ----------------------------------------------------
+// JobSystem.cpp
+// Work-stealing job scheduler with dependencies and parallel-for
+// ----------------------------------------------------
+
+#include "JobSystem.h"
+
+struct Job
+{
+	JobFunction function;
+	JobCounter* counter;
+	std::atomic<int> unfinished;		// Dependencies left, plus one until submitted
+	std::vector<JobHandle> continuations;
+	std::mutex continuation_mutex;
+};
+
+// Index of this thread's queue: 1..N for workers, 0 for anybody else
+static thread_local int queue_index = 0;
+
+JobSystem::JobSystem() : queued_jobs(0), quit(false)
+{}
+
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+void JobSystem::Start(int worker_count)
+{
+	if (workers.empty() == false) return;
+
+	if (worker_count <= 0)
+	{
+		int cores = (int)std::thread::hardware_concurrency();
+		worker_count = (cores > 1) ? cores - 1 : 1;
+	}
+
+	quit = false;
+	for (int i = 0; i <= worker_count; ++i)
+		queues.push_back(new WorkerQueue());
+
+	for (int i = 1; i <= worker_count; ++i)
+		workers.emplace_back(&JobSystem::WorkerThread, this, i);
+
+	LOG("Job system started with %d workers", worker_count);
+}
+
+void JobSystem::Stop()
+{
+	if (queues.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		quit = true;
+	}
+	wake_condition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+
+	// Jobs still queued run here, their counters may still be waited on (~AssetLoader
+	// does after Stop). Continuations they submit land in the queues and run too
+	while (RunOne())
+	{}
+
+	for (WorkerQueue* queue : queues)
+		delete queue;
+	queues.clear();
+}
+
+void JobSystem::Run(const JobFunction& function, JobCounter* counter)
+{
+	Submit(Create(function, counter));
+}
+
+JobHandle JobSystem::Create(const JobFunction& function, JobCounter* counter)
+{
+	JobHandle job = new Job();
+	job->function = function;
+	job->counter = counter;
+	job->unfinished = 1;
+
+	if (counter != NULL)
+		counter->value.fetch_add(1, std::memory_order_relaxed);
+
+	return job;
+}
+
+void JobSystem::Depend(JobHandle job, JobHandle dependency)
+{
+	job->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(dependency->continuation_mutex);
+	dependency->continuations.push_back(job);
+}
+
+void JobSystem::Submit(JobHandle job)
+{
+	if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		Push(job);
+}
+
+void JobSystem::ParallelFor(int count, int batch_size, const JobRangeFunction& function)
+{
+	if (count <= 0) return;
+	if (batch_size <= 0) batch_size = 1;
+
+	// Not started or a single batch: no point in going through the queues
+	if (workers.empty() || count <= batch_size)
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (int begin = 0; begin < count; begin += batch_size)
+	{
+		int end = (begin + batch_size < count) ? begin + batch_size : count;
+		Run([&function, begin, end]() { function(begin, end); }, &counter);
+	}
+
+	Wait(&counter);
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+	while (counter->value.load(std::memory_order_acquire) > 0)
+	{
+		if (RunOne() == false)
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::Push(JobHandle job)
+{
+	// Without workers there is nobody to hand it to
+	if (queues.empty())
+	{
+		Execute(job);
+		return;
+	}
+
+	WorkerQueue* queue = queues[queue_index];
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(job);
+	}
+
+	queued_jobs.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock orders us with a worker that is about to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	wake_condition.notify_one();
+}
+
+JobHandle JobSystem::Pop()
+{
+	if (queued_jobs.load(std::memory_order_acquire) <= 0) return NULL;
+
+	// Newest job from our own queue first, it is likely still in cache
+	{
+		WorkerQueue* queue = queues[queue_index];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->jobs.empty() == false)
+		{
+			JobHandle job = queue->jobs.back();
+			queue->jobs.pop_back();
+			queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	// Then steal the oldest job of somebody else
+	int count = (int)queues.size();
+	for (int i = 1; i < count; ++i)
+	{
+		WorkerQueue* queue = queues[(queue_index + i) % count];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->jobs.empty() == false)
+		{
+			JobHandle job = queue->jobs.front();
+			queue->jobs.pop_front();
+			queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+bool JobSystem::RunOne()
+{
+	JobHandle job = Pop();
+	if (job == NULL) return false;
+
+	Execute(job);
+	return true;
+}
+
+void JobSystem::Execute(JobHandle job)
+{
+	job->function();
+
+	std::vector<JobHandle> ready;
+	{
+		std::lock_guard<std::mutex> lock(job->continuation_mutex);
+		ready.swap(job->continuations);
+	}
+
+	for (JobHandle continuation : ready)
+		Submit(continuation);
+
+	if (job->counter != NULL)
+		job->counter->value.fetch_sub(1, std::memory_order_release);
+
+	delete job;
+}
+
+void JobSystem::WorkerThread(int index)
+{
+	queue_index = index;
+
+	while (true)
+	{
+		if (RunOne()) continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake_condition.wait(lock, [this] { return quit || queued_jobs.load(std::memory_order_acquire) > 0; });
+		if (quit) break;
+	}
+}
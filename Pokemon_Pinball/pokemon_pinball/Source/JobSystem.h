@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> JobFunction;
+typedef std::function<void(int begin, int end)> JobRangeFunction;
+
+struct Job;
+typedef Job* JobHandle;
+
+// Counts unfinished jobs, Wait() on it to join a group
+struct JobCounter
+{
+	std::atomic<int> value;
+
+	JobCounter() : value(0)
+	{}
+};
+
+// Work-stealing scheduler owned by Application. Every worker has its own deque:
+// it pops its newest job and steals the oldest one from the others when empty.
+// Threads that Wait() run jobs too, so waiting never idles a core.
+class JobSystem
+{
+public:
+
+	JobSystem();
+	~JobSystem();
+
+	// worker_count <= 0 uses one worker per core besides the main thread
+	void Start(int worker_count = 0);
+	// Runs whatever is still queued on the calling thread first, jobs submitted
+	// afterwards run right away on the thread that submits them
+	void Stop();
+
+	int GetWorkerCount() const { return (int)workers.size(); }
+
+	// Fire a job now, counter (optional) drops back when it is done
+	void Run(const JobFunction& function, JobCounter* counter = NULL);
+
+	// Graphs: Create jobs, link them with Depend, then Submit every job.
+	// A job starts once it is submitted and all its dependencies finished.
+	// Dependencies have to be linked before the dependency itself is submitted.
+	JobHandle Create(const JobFunction& function, JobCounter* counter = NULL);
+	void Depend(JobHandle job, JobHandle dependency);
+	void Submit(JobHandle job);
+
+	// Splits [0, count) in batches of batch_size and blocks until all are done
+	void ParallelFor(int count, int batch_size, const JobRangeFunction& function);
+
+	// Runs queued jobs until counter reaches zero
+	void Wait(JobCounter* counter);
+
+private:
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<JobHandle> jobs;
+	};
+
+	void Push(JobHandle job);
+	JobHandle Pop();
+	bool RunOne();
+	void Execute(JobHandle job);
+	void WorkerThread(int index);
+
+	std::vector<std::thread> workers;
+	std::vector<WorkerQueue*> queues;		// queues[0] is shared by threads that are not workers
+
+	std::atomic<int> queued_jobs;
+	std::mutex sleep_mutex;
+	std::condition_variable wake_condition;
+	bool quit;
+};
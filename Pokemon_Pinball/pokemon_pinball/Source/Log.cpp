@@ -1,16 +1,348 @@
-#pragma once
+// ----------------------------------------------------
+// Log.cpp
+// Lock-free log ring (bounded MPSC queue) and the flush
+// thread that formats records and writes the sinks
+// ----------------------------------------------------
 
 #include "Globals.h"
 
-void log(const char file[], int line, const char* format, ...)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define LOG_FLUSH_INTERVAL_MS 10
+
+static LogRecord ring[LOG_QUEUE_SIZE];
+static std::atomic<uint64_t> enqueue_position(0);
+static uint64_t dequeue_position = 0;		// Only touched by the flush thread
+static std::atomic<uint64_t> dropped(0);
+static std::atomic<int> min_level(LOG_LEVEL_DEBUG);
+static std::atomic<int> console_level(LOG_LEVEL_DEBUG);
+
+static std::thread flush_thread;
+static std::mutex flush_mutex;
+static std::condition_variable flush_condition;
+static bool flush_quit = false;
+static FILE* log_file = NULL;
+
+static const std::chrono::steady_clock::time_point log_epoch = std::chrono::steady_clock::now();
+
+// A slot is free for position p when its sequence is p and holds a record once it is p + 1.
+// Sequences are stored minus the slot index, so the zero initialised ring is already valid
+// and logging works from static constructors
+static uint64_t LoadSequence(const LogRecord* record)
+{
+	return record->sequence.load(std::memory_order_acquire) + (uint64_t)(record - ring);
+}
+
+static void StoreSequence(LogRecord* record, uint64_t sequence)
+{
+	record->sequence.store(sequence - (uint64_t)(record - ring), std::memory_order_release);
+}
+
+LogRecord* LogBegin(int level, const char* file, int line, const char* format)
+{
+	uint64_t position = enqueue_position.load(std::memory_order_relaxed);
+	LogRecord* record;
+
+	while (true)
+	{
+		record = &ring[position & (LOG_QUEUE_SIZE - 1)];
+		int64_t diff = (int64_t)LoadSequence(record) - (int64_t)position;
+
+		if (diff == 0)
+		{
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// Full: losing a line is better than stalling the frame
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return NULL;
+		}
+		else
+		{
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	record->position = position;
+	record->time = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - log_epoch).count();
+	record->file = file;
+	record->format = format;
+	record->line = line;
+	record->level = level;
+	record->size = 0;
+
+	return record;
+}
+
+void LogCommit(LogRecord* record)
+{
+	StoreSequence(record, record->position + 1);
+}
+
+// Formatting (flush thread only) ----------------------------------
+
+static const char* LevelName(int level)
 {
-	static char tmp_string[4096];
-	static char tmp_string2[4096];
-	static va_list  ap;
+	switch (level)
+	{
+	case LOG_LEVEL_DEBUG: return "DEBUG";
+	case LOG_LEVEL_INFO: return "INFO";
+	case LOG_LEVEL_WARNING: return "WARNING";
+	default: return "ERROR";
+	}
+}
+
+struct LogArgReader
+{
+	const LogRecord* record;
+	uint32_t offset;
+
+	bool Next(LogArgType type, void* out, uint32_t size)
+	{
+		if (offset + 1 + size > record->size || record->args[offset] != type) return false;
+		memcpy(out, record->args + offset + 1, size);
+		offset += 1 + size;
+		return true;
+	}
+};
+
+// Walks the format one conversion at a time, so each stored argument goes to
+// snprintf with the exact type its conversion expects
+static int FormatRecord(const LogRecord* record, char* out, int capacity)
+{
+	LogArgReader reader = { record, 0 };
+	int length = 0;
+	const char* c = record->format;
+
+	while (*c != '\0' && length < capacity - 1)
+	{
+		if (*c != '%')
+		{
+			out[length++] = *c++;
+			continue;
+		}
+
+		if (c[1] == '%')
+		{
+			out[length++] = '%';
+			c += 2;
+			continue;
+		}
+
+		// Copy the conversion spec, e.g. "%-16s" or "%.3f"
+		char spec[32];
+		int spec_length = 0;
+		spec[spec_length++] = *c++;
+		while (*c != '\0' && strchr("diuoxXfFeEgGaAcspn", *c) == NULL && spec_length < 30)
+			spec[spec_length++] = *c++;
+		if (*c == '\0') break;
+
+		char conversion = *c++;
+		spec[spec_length++] = conversion;
+		spec[spec_length] = '\0';
+
+		bool is_long_long = strstr(spec, "ll") != NULL || strchr(spec, 'j') != NULL || strchr(spec, 'z') != NULL;
+		bool is_long = is_long_long == false && strchr(spec, 'l') != NULL;
+
+		char* dst = out + length;
+		int left = capacity - length;
+		int written = 0;
+
+		switch (conversion)
+		{
+		case 'd': case 'i': case 'c':
+		{
+			int64_t v = 0;
+			uint64_t u = 0;
+			if (reader.Next(LOG_ARG_INT, &v, sizeof(v)) == false && reader.Next(LOG_ARG_UINT, &u, sizeof(u)))
+				v = (int64_t)u;
+			if (is_long_long) written = snprintf(dst, left, spec, (long long)v);
+			else if (is_long) written = snprintf(dst, left, spec, (long)v);
+			else written = snprintf(dst, left, spec, (int)v);
+		}
+		break;
+
+		case 'u': case 'o': case 'x': case 'X':
+		{
+			uint64_t u = 0;
+			int64_t v = 0;
+			if (reader.Next(LOG_ARG_UINT, &u, sizeof(u)) == false && reader.Next(LOG_ARG_INT, &v, sizeof(v)))
+				u = (uint64_t)v;
+			if (is_long_long) written = snprintf(dst, left, spec, (unsigned long long)u);
+			else if (is_long) written = snprintf(dst, left, spec, (unsigned long)u);
+			else written = snprintf(dst, left, spec, (unsigned int)u);
+		}
+		break;
+
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		{
+			double d = 0.0;
+			reader.Next(LOG_ARG_DOUBLE, &d, sizeof(d));
+			written = snprintf(dst, left, spec, d);
+		}
+		break;
+
+		case 's':
+		{
+			uint16_t size = 0;
+			char text[LOG_ARGS_SIZE + 1] = "";
+			if (reader.Next(LOG_ARG_STRING, &size, sizeof(size)))
+			{
+				memcpy(text, record->args + reader.offset, size);
+				text[size] = '\0';
+				reader.offset += size;
+			}
+			written = snprintf(dst, left, spec, text);
+		}
+		break;
+
+		case 'p':
+		{
+			const void* p = NULL;
+			reader.Next(LOG_ARG_POINTER, &p, sizeof(p));
+			written = snprintf(dst, left, spec, p);
+		}
+		break;
+
+		default:
+			// %n is never honoured
+			break;
+		}
+
+		if (written > 0)
+			length += (written < left) ? written : left - 1;
+	}
 
-	// Construct the string from variable arguments
-	va_start(ap, format);
-	vsprintf_s(tmp_string, 4096, format, ap);
-	va_end(ap);
-	sprintf_s(tmp_string2, 4096, "\n%s(%d) : %s", file, line, tmp_string);
-}
\ No newline at end of file
+	out[length] = '\0';
+	return length;
+}
+
+static void WriteRecord(const LogRecord* record)
+{
+	char message[1024];
+	FormatRecord(record, message, sizeof(message));
+
+	// __FILE__ may be a full path
+	const char* file = record->file;
+	for (const char* c = record->file; *c != '\0'; ++c)
+	{
+		if (*c == '/' || *c == '\\') file = c + 1;
+	}
+
+	char line[1280];
+	snprintf(line, sizeof(line), "[%8.3f] %-7s %s(%d) : %s\n", record->time / 1000000.0, LevelName(record->level), file, record->line, message);
+
+	if (record->level >= console_level.load(std::memory_order_relaxed))
+		fputs(line, (record->level >= LOG_LEVEL_WARNING) ? stderr : stdout);
+
+	if (log_file != NULL)
+		fputs(line, log_file);
+}
+
+// Consumes every committed record, returns how many were written
+static int Drain()
+{
+	int count = 0;
+
+	while (true)
+	{
+		LogRecord* record = &ring[dequeue_position & (LOG_QUEUE_SIZE - 1)];
+		if (LoadSequence(record) != dequeue_position + 1)
+			break;
+
+		WriteRecord(record);
+
+		// Hand the slot back to the producers for the next lap
+		StoreSequence(record, dequeue_position + LOG_QUEUE_SIZE);
+		++dequeue_position;
+		++count;
+	}
+
+	if (count > 0 && log_file != NULL)
+		fflush(log_file);
+
+	return count;
+}
+
+static void FlushThread()
+{
+	std::unique_lock<std::mutex> lock(flush_mutex);
+
+	while (flush_quit == false)
+	{
+		lock.unlock();
+		Drain();
+		lock.lock();
+
+		// Producers never signal, a short timeout keeps them lock-free
+		flush_condition.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS));
+	}
+
+	lock.unlock();
+	Drain();
+}
+
+void LogStart(const char* file_path)
+{
+	if (flush_thread.joinable()) return;
+
+	if (file_path != NULL)
+	{
+		log_file = fopen(file_path, "w");
+		if (log_file == NULL)
+			fprintf(stderr, "Cannot open log file %s\n", file_path);
+	}
+
+	flush_quit = false;
+	flush_thread = std::thread(FlushThread);
+}
+
+void LogStop()
+{
+	if (flush_thread.joinable() == false) return;
+
+	{
+		std::lock_guard<std::mutex> lock(flush_mutex);
+		flush_quit = true;
+	}
+	flush_condition.notify_all();
+	flush_thread.join();
+
+	uint64_t lost = dropped.exchange(0);
+	if (lost > 0)
+	{
+		fprintf(stderr, "Log ring was full, %llu records dropped\n", (unsigned long long)lost);
+		if (log_file != NULL) fprintf(log_file, "Log ring was full, %llu records dropped\n", (unsigned long long)lost);
+	}
+
+	if (log_file != NULL)
+	{
+		fclose(log_file);
+		log_file = NULL;
+	}
+}
+
+void LogSetLevel(int level)
+{
+	min_level.store(level, std::memory_order_relaxed);
+}
+
+void LogSetConsoleLevel(int level)
+{
+	console_level.store(level, std::memory_order_relaxed);
+}
+
+int LogGetLevel()
+{
+	return min_level.load(std::memory_order_relaxed);
+}
+
+uint64_t LogGetDropped()
+{
+	return dropped.load(std::memory_order_relaxed);
+}
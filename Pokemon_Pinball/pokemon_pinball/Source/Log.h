@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Logging: LOG_* calls copy their arguments into a lock-free ring and return,
+// a background thread does the formatting and writes the sinks
+
+#define LOG_LEVEL_DEBUG		0
+#define LOG_LEVEL_INFO		1
+#define LOG_LEVEL_WARNING	2
+#define LOG_LEVEL_ERROR		3
+#define LOG_LEVEL_NONE		4
+
+// Calls below this level are not compiled at all
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_QUEUE_SIZE		4096	// Records, must be a power of two
+#define LOG_ARGS_SIZE		216		// Bytes of arguments per record, long strings get cut
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) LogWrite(LOG_LEVEL_DEBUG, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#else
+#define LOG_DEBUG(format, ...)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_INFO
+#define LOG(format, ...) LogWrite(LOG_LEVEL_INFO, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#else
+#define LOG(format, ...)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(format, ...) LogWrite(LOG_LEVEL_WARNING, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#else
+#define LOG_WARNING(format, ...)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) LogWrite(LOG_LEVEL_ERROR, __FILE__, __LINE__, format, ##__VA_ARGS__);
+#else
+#define LOG_ERROR(format, ...)
+#endif
+
+enum LogArgType : uint8_t
+{
+	LOG_ARG_INT,
+	LOG_ARG_UINT,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER
+};
+
+// One slot of the ring. Arguments are stored as a type tag followed by the raw value,
+// strings are copied since the caller's buffer may be gone by the time we format
+struct LogRecord
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t position;
+	uint64_t time;
+	const char* file;
+	const char* format;		// Must be a string literal
+	int line;
+	int level;
+	uint32_t size;
+	uint8_t args[LOG_ARGS_SIZE];
+};
+
+// Sinks ---------------------------------------------------------
+// Starts the flush thread, file_path can be NULL for console only
+void LogStart(const char* file_path);
+// Writes everything still queued and stops the flush thread
+void LogStop();
+void LogSetLevel(int level);
+void LogSetConsoleLevel(int level);
+int LogGetLevel();
+uint64_t LogGetDropped();
+
+// Producer side -------------------------------------------------
+// Claims a slot, NULL when the ring is full (the record is dropped, the caller never waits)
+LogRecord* LogBegin(int level, const char* file, int line, const char* format);
+void LogCommit(LogRecord* record);
+
+inline void LogPutRaw(LogRecord* record, LogArgType type, const void* data, uint32_t size)
+{
+	if (record->size + 1 + size > LOG_ARGS_SIZE) return;
+
+	record->args[record->size++] = type;
+	memcpy(record->args + record->size, data, size);
+	record->size += size;
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value>::type LogPut(LogRecord* record, T value)
+{
+	if (std::is_signed<T>::value)
+	{
+		int64_t v = (int64_t)value;
+		LogPutRaw(record, LOG_ARG_INT, &v, sizeof(v));
+	}
+	else
+	{
+		uint64_t v = (uint64_t)value;
+		LogPutRaw(record, LOG_ARG_UINT, &v, sizeof(v));
+	}
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_enum<T>::value>::type LogPut(LogRecord* record, T value)
+{
+	int64_t v = (int64_t)value;
+	LogPutRaw(record, LOG_ARG_INT, &v, sizeof(v));
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type LogPut(LogRecord* record, T value)
+{
+	double v = (double)value;
+	LogPutRaw(record, LOG_ARG_DOUBLE, &v, sizeof(v));
+}
+
+inline void LogPut(LogRecord* record, const char* value)
+{
+	if (value == NULL) value = "(null)";
+
+	// Length prefixed, cut to what is left in the record
+	const uint32_t header = 1 + sizeof(uint16_t);
+	if (record->size + header > LOG_ARGS_SIZE) return;
+
+	size_t length = strlen(value);
+	size_t available = LOG_ARGS_SIZE - record->size - header;
+	uint16_t size = (uint16_t)((length < available) ? length : available);
+
+	record->args[record->size++] = LOG_ARG_STRING;
+	memcpy(record->args + record->size, &size, sizeof(size));
+	memcpy(record->args + record->size + sizeof(size), value, size);
+	record->size += sizeof(size) + size;
+}
+
+template<typename T>
+inline typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type LogPut(LogRecord* record, T* value)
+{
+	const void* v = (const void*)value;
+	LogPutRaw(record, LOG_ARG_POINTER, &v, sizeof(v));
+}
+
+inline void LogPutAll(LogRecord* record)
+{}
+
+template<typename T, typename... Rest>
+inline void LogPutAll(LogRecord* record, T value, Rest... rest)
+{
+	LogPut(record, value);
+	LogPutAll(record, rest...);
+}
+
+template<typename... Args>
+inline void LogWrite(int level, const char* file, int line, const char* format, Args... args)
+{
+	if (level < LogGetLevel()) return;
+
+	LogRecord* record = LogBegin(level, file, line, format);
+	if (record == NULL) return;
+
+	LogPutAll(record, args...);
+	LogCommit(record);
+}
@@ -16,6 +16,7 @@ enum main_states
 
 int main(int argc, char ** argv)
 {
+	LogStart(LOG_FILE);
 	LOG("Starting game '%s'...", TITLE);
 
 	int main_return = EXIT_FAILURE;
@@ -38,7 +39,7 @@ int main(int argc, char ** argv)
 			LOG("-------------- Application Init --------------");
 			if (App->Init() == false)
 			{
-				LOG("Application Init exits with ERROR");
+				LOG_ERROR("Application Init exits with ERROR");
 				state = MAIN_EXIT;
 			}
 			else
@@ -55,7 +56,7 @@ int main(int argc, char ** argv)
 
 			if (update_return == UPDATE_ERROR)
 			{
-				LOG("Application Update exits with ERROR");
+				LOG_ERROR("Application Update exits with ERROR");
 				state = MAIN_EXIT;
 			}
 
@@ -69,7 +70,7 @@ int main(int argc, char ** argv)
 			LOG("-------------- Application CleanUp --------------");
 			if (App->CleanUp() == false)
 			{
-				LOG("Application CleanUp exits with ERROR");
+				LOG_ERROR("Application CleanUp exits with ERROR");
 			}
 			else
 				main_return = EXIT_SUCCESS;
@@ -82,6 +83,7 @@ int main(int argc, char ** argv)
 	}
 
 	delete App;
-	LOG("Exiting game '%s'...\n", TITLE);
+	LOG("Exiting game '%s'...", TITLE);
+	LogStop();
 	return main_return;
 }
\ No newline at end of file
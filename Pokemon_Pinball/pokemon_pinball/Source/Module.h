@@ -12,8 +12,9 @@ private :
 
 public:
 	Application* App;
+	const char* name;	// Set by Application::AddModule, used by the profiler
 
-	Module(Application* parent, bool start_enabled = true) : App(parent), enabled(start_enabled)
+	Module(Application* parent, bool start_enabled = true) : App(parent), name("Module"), enabled(start_enabled)
 	{}
 
 	virtual ~Module()
@@ -82,7 +82,30 @@ unsigned int ModuleAudio::LoadFx(const char* path)
 
 	if(sound.stream.buffer == NULL)
 	{
-		LOG("Cannot load sound: %s", path);
+		LOG_WARNING("Cannot load sound: %s", path);
+	}
+	else
+	{
+        fx[fx_count] = sound;
+		ret = fx_count++;
+	}
+
+	return ret;
+}
+
+// Load decoded WAV
+unsigned int ModuleAudio::LoadFx(Wave wave, const char* path)
+{
+	if(IsEnabled() == false)
+		return 0;
+
+	unsigned int ret = 0;
+
+	Sound sound = LoadSoundFromWave(wave);
+
+	if(sound.stream.buffer == NULL)
+	{
+		LOG_WARNING("Cannot load sound: %s", path);
 	}
 	else
 	{
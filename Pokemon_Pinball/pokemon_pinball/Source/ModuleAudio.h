@@ -21,6 +21,9 @@ public:
 	// Load a sound in memory
 	unsigned int LoadFx(const char* path);
 
+	// Same from an already decoded wave, the wave stays owned by the caller
+	unsigned int LoadFx(Wave wave, const char* path);
+
 	// Play a previously loaded sound
 	bool PlayFx(unsigned int fx, int repeat = 0);
 
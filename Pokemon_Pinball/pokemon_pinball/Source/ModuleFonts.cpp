@@ -19,7 +19,7 @@ bool ModuleFonts::LoadFontTexture(const std::string& file_path, char first_chara
     font_texture = LoadTexture(file_path.c_str());
     if (font_texture.id == 0)
     {
-        LOG("Failed to load font texture");
+        LOG_ERROR("Failed to load font texture");
         return false;
     }
 
@@ -49,7 +49,7 @@ void ModuleFonts::DrawCharacter(int x, int y, char c, const Color& col) const
 
     if (coord_x < 0 || coord_x >= columns || coord_y < 0 || coord_y >= rows)
     {
-        LOG("Invalid character index when drawing text: (%d,%d)", coord_x, coord_y);
+        LOG_WARNING("Invalid character index when drawing text: (%d,%d)", coord_x, coord_y);
         return;
     }
 
@@ -1,10 +1,18 @@
 #include "Globals.h"
 #include "Application.h"
+#include "AssetLoader.h"
 #include "ModuleRender.h"
 #include "ModuleGame.h"
 #include "ModuleAudio.h"
 #include "ModulePhysics.h"
 #include "ModuleFonts.h"
+#include "ModuleInput.h"
+#include "FlipperController.h"
+#include "HeapStats.h"
+#include "Profiler.h"
+#include "StateBuffer.h"
+
+#include <algorithm>
 
 class PhysicEntity
 {
@@ -15,11 +23,33 @@ protected:
 		, listener(_listener)
 	{
 		body->listener = listener;
+		body->entity = this;
 	}
 
 public:
 	virtual ~PhysicEntity() = default;
-	virtual void Update() = 0;
+
+	// Game logic, runs every frame (also in headless mode)
+	virtual void Update() {
+	}
+	// Rendering only, never touches the simulation
+	virtual void Draw() {
+	}
+	// Motor commands from the latched controls, right before each physics tick.
+	// May run on the physics thread: only touch this entity's bodies and joints
+	virtual void ApplyInput(const TickInput& input) {
+	}
+
+	// Game state for snapshots, the bodies are restored by ModulePhysics.
+	// Animation timers only change what is drawn and are left out
+	virtual void SaveState(std::vector<uint8>& state) const {
+		PutState(state, letterVisible);
+		PutState(state, letterVisible2);
+		PutState(state, letterVisible3);
+	}
+	virtual bool LoadState(const uint8*& in, const uint8* end) {
+		return GetState(in, end, letterVisible) && GetState(in, end, letterVisible2) && GetState(in, end, letterVisible3);
+	}
 
 	virtual int RayHit(vec2<int> ray, vec2<int> mouse, vec2<float>& normal)
 	{
@@ -53,24 +83,40 @@ protected:
 	
 };
 
+// Pooled by ModuleGame: created once, then parked and spawned again.
+// Balls in play are the POKEBALL circles registered in ModulePhysics, not part of entities
 class Circle : public PhysicEntity
 {
 public:
-	Circle(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateCircle(_x, _y, 15, DYNAMIC, POKEBALL), _listener)
+	Circle(ModulePhysics* physics, Module* _listener, Texture2D _texture)
+		: PhysicEntity(physics->CreateCircle(-100, -100, BALL_RADIUS, DYNAMIC, POKEBALL), _listener)
 		, texture(_texture)
 	{
 		frameCount = 16;
 		currentFrame = frameCount - 1; 
+		Park();
 	}
 
-	void Update() override
+	void Spawn(int x, int y)
 	{
+		body->Teleport(x, y);
+		listener->App->physics->SetBodyEnabled(body, true);
+		LOG_DEBUG("Ball spawned at %d, %d", x, y);
+	}
+
+	void Park()
+	{
+		listener->App->physics->SetBodyEnabled(body, false);
+	}
+
+	void Draw() override
+	{
+		float alpha = listener->App->physics->GetInterpolationAlpha();
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetInterpolatedPosition(x, y, alpha);
 		Vector2 position{ (float)x, (float)y };
 
-		float rotation = body->GetRotation() * RAD2DEG; //radianes a grados
+		float rotation = body->GetInterpolatedRotation(alpha) * RAD2DEG; //radianes a grados
 
 		currentFrame = frameCount - 1 - (static_cast<int>((rotation / 360.0f) * frameCount) % frameCount);
 		
@@ -98,13 +144,14 @@ public:
 
 	}
 
-	void Update() override
+	void Draw() override
 	{
+		float alpha = listener->App->physics->GetInterpolationAlpha();
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetInterpolatedPosition(x, y, alpha);
 		DrawTexturePro(texture, Rectangle{ 0, 0, (float)texture.width, (float)texture.height },
 			Rectangle{ (float)x, (float)y, (float)texture.width, (float)texture.height },
-			Vector2{ (float)texture.width / 2.0f, (float)texture.height / 2.0f}, body->GetRotation() * RAD2DEG, WHITE);
+			Vector2{ (float)texture.width / 2.0f, (float)texture.height / 2.0f}, body->GetInterpolatedRotation(alpha) * RAD2DEG, WHITE);
 	}
 
 	int RayHit(vec2<int> ray, vec2<int> mouse, vec2<float>& normal) override
@@ -117,116 +164,103 @@ private:
 
 };
 
+// The pivot sits at the outer end of the 60 px bar, at _x, _y
 class LeftPad : public PhysicEntity
 {
 public:
 	LeftPad(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateLeftFlipper(_x, _y), _listener)
+		: PhysicEntity(physics->CreateFlipper(_x, _y, 60, 10), _listener)
 		, texture(_texture)
-		, leftAnchor(nullptr)
-		, leftJoint(nullptr)
-	{
-		// Crear anclaje estático para la pala izquierda
-		b2Vec2 anchorLeft(PIXEL_TO_METERS(_x), PIXEL_TO_METERS(_y));
-		b2BodyDef anchorDef;
-		anchorDef.type = b2_staticBody;
-		anchorDef.position = anchorLeft;
-		leftAnchor = physics->GetWorld()->CreateBody(&anchorDef);
-
-		// Configurar la revolute joint para la pala izquierda
-		b2RevoluteJointDef jointDef;
-		jointDef.bodyA = leftAnchor;
-		jointDef.bodyB = body->body;
-		jointDef.localAnchorA.SetZero();
-		jointDef.localAnchorB.Set(-PIXEL_TO_METERS(30), 0); // Punto de anclaje en la pala
-		jointDef.enableMotor = true;
-		jointDef.maxMotorTorque = 1000.0f;
-		jointDef.enableLimit = true;
-		jointDef.lowerAngle = -30.0f * b2_pi / 180.0f;
-		jointDef.upperAngle = 30.0f * b2_pi / 180.0f;
-
-		leftJoint = (b2RevoluteJoint*)physics->GetWorld()->CreateJoint(&jointDef);
+	{
+		// Held it swings up to -30 degrees, released it falls back to 30
+		flipper.Init(body->body, b2Vec2(PIXEL_TO_METERS(_x), PIXEL_TO_METERS(_y)), b2Vec2(PIXEL_TO_METERS(30), 0.0f),
+			30.0f * DEGTORAD, -30.0f * DEGTORAD);
 	}
 
-	void Update() override
+	void ApplyInput(const TickInput& input) override
 	{
-		// Control de rotación de la pala izquierda con el teclado
-		if (IsKeyDown(KEY_A)) {
-			leftJoint->SetMotorSpeed(-60.0f); // Rotación en sentido horario
-		}
-		else {
-			leftJoint->SetMotorSpeed(60.0f); // Retorno en sentido antihorario
-		}
+		flipper.Drive(input.left_flipper, 1.0f / listener->App->physics->GetTickRate());
+	}
+
+	void SaveState(std::vector<uint8>& state) const override
+	{
+		PhysicEntity::SaveState(state);
+		PutState(state, flipper.GetSwing());
+	}
 
+	bool LoadState(const uint8*& in, const uint8* end) override
+	{
+		FlipperSwing swing;
+		if (PhysicEntity::LoadState(in, end) == false || GetState(in, end, swing) == false)
+			return false;
+		flipper.SetSwing(swing);
+		return true;
+	}
+
+	void Draw() override
+	{
+		float alpha = listener->App->physics->GetInterpolationAlpha();
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetInterpolatedPosition(x, y, alpha);
 		DrawTexturePro(texture,
 			Rectangle{ 0, 0, (float)texture.width, (float)texture.height },
 			Rectangle{ (float)x, (float)y, (float)texture.width, (float)texture.height },
 			Vector2{ (float)texture.width / 2, (float)texture.height / 2 },
-			body->GetRotation() * RAD2DEG, WHITE);
+			body->GetInterpolatedRotation(alpha) * RAD2DEG, WHITE);
 	}
 
 private:
 	Texture2D texture;
-	b2Body* leftAnchor;
-	b2RevoluteJoint* leftJoint;
+	FlipperController flipper;
 };
 
 class RightPad : public PhysicEntity
 {
 public:
 	RightPad(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateRightFlipper(_x, _y), _listener)
+		: PhysicEntity(physics->CreateFlipper(_x, _y, 60, 10), _listener)
 		, texture(_texture)
-		, rightAnchor(nullptr)
-		, rightJoint(nullptr)
-	{
-		// Crear anclaje estático para la pala derecha
-		b2Vec2 anchorRight(PIXEL_TO_METERS(_x), PIXEL_TO_METERS(_y));
-		b2BodyDef anchorDef;
-		anchorDef.type = b2_staticBody;
-		anchorDef.position = anchorRight;
-		rightAnchor = physics->GetWorld()->CreateBody(&anchorDef);
-
-		// Configurar la revolute joint para la pala derecha
-		b2RevoluteJointDef jointDef;
-		jointDef.bodyA = rightAnchor;
-		jointDef.bodyB = body->body;
-		jointDef.localAnchorA.SetZero();
-		jointDef.localAnchorB.Set(PIXEL_TO_METERS(30), 0); // Ajuste de anclaje para pivote en el lado izquierdo
-		jointDef.enableMotor = true;
-		jointDef.maxMotorTorque = 1000.0f;
-		jointDef.enableLimit = true;
-		jointDef.lowerAngle = -30.0f * b2_pi / 180.0f;  // Límite inferior (mirando hacia abajo)
-		jointDef.upperAngle = 30.0f * b2_pi / 180.0f; // Límite superior (hacia arriba)
-
-		rightJoint = (b2RevoluteJoint*)physics->GetWorld()->CreateJoint(&jointDef);
+	{
+		// Mirrored: held it swings up to 30 degrees, released it falls back to -30
+		flipper.Init(body->body, b2Vec2(PIXEL_TO_METERS(_x), PIXEL_TO_METERS(_y)), b2Vec2(-PIXEL_TO_METERS(30), 0.0f),
+			-30.0f * DEGTORAD, 30.0f * DEGTORAD);
 	}
 
-	void Update() override
+	void ApplyInput(const TickInput& input) override
 	{
-		// Control de rotación de la pala derecha con el teclado
-		if (IsKeyDown(KEY_D)) {
-			rightJoint->SetMotorSpeed(60.0f); // Rotación en sentido horario (hacia arriba)
-		}
-		else {
-			rightJoint->SetMotorSpeed(-60.0f); // Retorno en sentido antihorario (hacia abajo)
-		}
+		flipper.Drive(input.right_flipper, 1.0f / listener->App->physics->GetTickRate());
+	}
+
+	void SaveState(std::vector<uint8>& state) const override
+	{
+		PhysicEntity::SaveState(state);
+		PutState(state, flipper.GetSwing());
+	}
 
+	bool LoadState(const uint8*& in, const uint8* end) override
+	{
+		FlipperSwing swing;
+		if (PhysicEntity::LoadState(in, end) == false || GetState(in, end, swing) == false)
+			return false;
+		flipper.SetSwing(swing);
+		return true;
+	}
+
+	void Draw() override
+	{
+		float alpha = listener->App->physics->GetInterpolationAlpha();
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetInterpolatedPosition(x, y, alpha);
 		DrawTexturePro(texture,
 			Rectangle{ 0, 0, (float)texture.width, (float)texture.height },
 			Rectangle{ (float)x, (float)y, (float)texture.width, (float)texture.height },
 			Vector2{ (float)texture.width / 2, (float)texture.height / 2 },
-			body->GetRotation() * RAD2DEG, WHITE);
+			body->GetInterpolatedRotation(alpha) * RAD2DEG, WHITE);
 	}
 
 private:
 	Texture2D texture;
-	b2Body* rightAnchor;
-	b2RevoluteJoint* rightJoint;
+	FlipperController flipper;
 };
 
 class Spring : public PhysicEntity {
@@ -271,11 +305,18 @@ public:
 		springJoint = (b2PrismaticJoint*)physics->GetWorld()->CreateJoint(&prismaticJointDef);
 	}
 
-	void Update() override {
-		// Control de animación y movimiento del resorte con la tecla S
-		if (IsKeyDown(KEY_S)) {
+	void ApplyInput(const TickInput& input) override {
+		if (input.plunger) {
 			springJoint->SetMotorSpeed(3.0f); // Comprimir resorte
+		}
+		else {
+			springJoint->SetMotorSpeed(-20.0f);  // Soltar resorte
+		}
+	}
 
+	void Update() override {
+		// Control de animación del resorte con la tecla S
+		if (listener->App->input->GetFrameInput().controls.plunger) {
 			// Temporizador para controlar la velocidad de la animación
 			animationTimer += GetFrameTime();
 			if (animationTimer >= frameSpeed) {
@@ -293,13 +334,14 @@ public:
 			}
 		}
 		else {
-			springJoint->SetMotorSpeed(-20.0f);  // Soltar resorte
 			currentFrame = 0; // Vuelve al primer frame cuando no se presiona la tecla
 		}
+	}
 
+	void Draw() override {
 		// Obtener la posición del pistón del resorte
 		int x, y;
-		springPiston->GetPhysicPosition(x, y);
+		springPiston->GetInterpolatedPosition(x, y, listener->App->physics->GetInterpolationAlpha());
 
 		// Dibujar la textura del resorte en el frame actual
 		Rectangle source = { currentFrame * frameWidth, 0, frameWidth, frameHeight };
@@ -346,11 +388,6 @@ void ActivateHit() override {
 
 void Update() override
 {
-	int x, y;
-	body->GetPhysicPosition(x, y);
-	Vector2 position{ (float)x, (float)y };
-
-
 	// Animación idle
 	if (!isHit) {
 		frameTimer += animationSpeed;
@@ -376,6 +413,13 @@ void Update() override
 			currentFrame = 0;  // Reinicia la animación idle al primer frame
 		}
 	}
+}
+
+void Draw() override
+{
+	int x, y;
+	body->GetDrawPosition(x, y);
+	Vector2 position{ (float)x, (float)y };
 
 	Rectangle source = { currentFrame * 32.0f, 0.0f, 32.0f, 32.0f };
 	Rectangle dest = { position.x, position.y, 32.0f * scale, 32.0f * scale };
@@ -419,16 +463,20 @@ public:
 	}
 		void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
 		{
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
+
 	Rectangle source = { currentFrame * 64.0f, 0.0f, 64.0f, 64.0f };
 		Rectangle dest = { position.x, position.y, 64.0f * scale, 64.0f * scale };
 		Vector2 origin = { 70.0f , 70.0f  }; 
@@ -459,16 +507,19 @@ public:
 	}
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
 		{
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		// Calcula el rect�ngulo de origen para el cuadro actual
 		Rectangle source = { currentFrame * 64.0f, 0.0f, 64.0f, 48.0f };
@@ -501,16 +552,19 @@ public:
 	}
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
 		{
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source = { currentFrame * 64.0f, 0.0f, 64.0f, 64.0f };
 		Rectangle dest = { position.x, position.y, 64.0f * scale, 64.0f * scale };
@@ -541,10 +595,6 @@ public:
 	}
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		// Avanza el temporizador de animaci�n
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
@@ -553,6 +603,13 @@ public:
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		// Calcula el rect�ngulo de origen para el cuadro actual
 		Rectangle source = { currentFrame * 96.0f, 0.0f, 96.0f, 96.0f };
@@ -585,10 +642,6 @@ public:
 	}
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		// Avanza el temporizador de animaci�n
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
@@ -597,6 +650,13 @@ public:
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		// Calcula el rect�ngulo de origen para el cuadro actual
 		Rectangle source = { currentFrame * 64.0f, 0.0f, 64.0f, 80.0f };
@@ -618,7 +678,7 @@ private:
 class Latios : public PhysicEntity {
 public:
 	Latios(ModulePhysics* physics, int x, int y, Module* listener, Texture2D texture, float speedX)
-		: PhysicEntity(physics->CreateCircle(x, y, 10, STATIC, ELSE), listener), texture(texture), speedX(speedX)
+		: PhysicEntity(physics->CreateCircle(x, y, 10, STATIC, ELSE), listener), texture(texture), speedX(speedX), posX((float)x)
 	{
 		scale = 1.25f;
 		isMarkedForDeletion = false;
@@ -641,20 +701,27 @@ public:
 		posX += speedX;
 
 		// Comprueba si la posición supera la anchura de la ventana y marca para eliminación
-		if (posX > GetScreenWidth() + 50) {
+		if (posX > SCREEN_WIDTH + 50) {
 			isMarkedForDeletion = true;
 			return; // No seguir dibujando si está marcado para eliminar
 		}
-		if (posX > GetScreenWidth() - 45) {
+		if (posX > SCREEN_WIDTH - 45) {
 			hasToSpawnBall = true;
 		}
 		else {
 			hasToSpawnBall = false;
 		}
+	}
+
+	void Draw() override
+	{
+		if (isMarkedForDeletion) {
+			return;
+		}
 
 		// Obtiene la posición física de `y` para mantener el valor actual
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetDrawPosition(x, y);
 
 		// Usa `posX` en lugar de `x` para el dibujado
 		Vector2 position{ posX, (float)y };
@@ -670,6 +737,29 @@ public:
 		return isMarkedForDeletion;
 	}
 
+	void SaveState(std::vector<uint8>& state) const override
+	{
+		PhysicEntity::SaveState(state);
+		PutState(state, posX);
+		PutState(state, isMarkedForDeletion);
+		PutState(state, hasToSpawnBall);
+		PutState(state, pokeballSpawned);
+	}
+
+	bool LoadState(const uint8*& in, const uint8* end) override
+	{
+		return PhysicEntity::LoadState(in, end) && GetState(in, end, posX) && GetState(in, end, isMarkedForDeletion)
+			&& GetState(in, end, hasToSpawnBall) && GetState(in, end, pokeballSpawned);
+	}
+
+	// Back to the left edge for another pass, instead of creating a new Latios
+	void Reset(int x) {
+		posX = (float)x;
+		isMarkedForDeletion = false;
+		hasToSpawnBall = false;
+		pokeballSpawned = false;
+	}
+
 private:
 	Texture2D texture;
 	float scale;
@@ -687,11 +777,11 @@ public:
 		sensors = DELETE;
 
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -778,19 +868,20 @@ public:
 
 
 	};
+	static constexpr auto outline = PixelOutline(CollisionOne);
 
 	Collision1(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionOne, 140), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -815,18 +906,19 @@ public:
 	220, 938,
 	209, 949
 	};
+	static constexpr auto outline = PixelOutline(CollisionTwo);
 
 	Collision2(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionTwo, 24), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -851,19 +943,20 @@ public:
 	472, 883,
 	445, 901
 	};
+	static constexpr auto outline = PixelOutline(CollisionTree);
 
 	Collision3(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionTree, 24), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -895,9 +988,10 @@ public:
 	369, 872,
 	365, 866
 	};
+	static constexpr auto outline = PixelOutline(CollisionFour);
 
 	Collision4(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionFour, 38), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
@@ -915,10 +1009,6 @@ public:
 
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		if (Hit) // activate attack anim
 		{
 			hitTimer += GetFrameTime();
@@ -928,6 +1018,13 @@ public:
 				hitTimer = 0.0f;
 			}
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source;
 		if (Hit)
@@ -942,7 +1039,6 @@ public:
 		Rectangle dest = { position.x, position.y, 80.0f * scale, 80.0f * scale };
 		Vector2 origin = { -364.0f , -778.0f };
 		DrawTexturePro(texture, source, dest, origin, 0.0f, WHITE); 
-	
 	}
 
 	void OnHit()
@@ -986,9 +1082,10 @@ public:
 	210, 867,
 	205, 872
 	};
+	static constexpr auto outline = PixelOutline(CollisionFive);
 
 	Collision5(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionFive, 40), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
@@ -1006,11 +1103,6 @@ public:
 
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
-
 		if (Hit) // activate attack anim
 		{
 			hitTimer += GetFrameTime();
@@ -1020,6 +1112,13 @@ public:
 				hitTimer = 0.0f;
 			}
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source;
 		if (Hit)
@@ -1090,9 +1189,10 @@ public:
 	196, 443
 
 	};
+	static constexpr auto outline = PixelOutline(CollisionSix);
 
 	Collision6(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionSix, 62), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
@@ -1104,16 +1204,19 @@ public:
 	}
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		frameTimer += animationSpeed;
 		if (frameTimer >= 1.0f)
 		{
 			currentFrame = (currentFrame + 1) % frameCount;
 			frameTimer = 0.0f;
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source = { currentFrame * 80.0f, 0.0f, 80.0f, 80.0f };
 		Rectangle dest = { position.x, position.y, 80.0f * scale, 80.0f * scale };
@@ -1176,19 +1279,20 @@ public:
 	182, 617
 
 	};
+	static constexpr auto outline = PixelOutline(GreenEvoDerechaCollision);
 
 	GreenEvoD(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, GreenEvoDerechaCollision, 78), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1213,19 +1317,20 @@ public:
 	159, 802
 
 	};
+	static constexpr auto outline = PixelOutline(TICP);
 
 	TrianguloIzqColPunt(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, TICP, 22), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = TRIANGULOIZQ; 
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 private:
 	Texture2D texture;
@@ -1238,12 +1343,6 @@ public:
 	{
 		collisionType = TRIANGULOIZQ;
 	}
-	void Update() override
-	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-	}
 private:
 	Texture2D texture;
 };
@@ -1260,19 +1359,20 @@ public:
 	370, 863
 
 	};
+	static constexpr auto outline = PixelOutline(TDCP);
 
 	TrianguloDerColPunt(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, TDCP, 10), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = TRIANGULODER; 
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 private:
 	Texture2D texture;
@@ -1285,12 +1385,6 @@ public:
 	{
 		collisionType = TRIANGULODER; 
 	}
-	void Update() override
-	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-	}
 private:
 	Texture2D texture;
 };
@@ -1315,19 +1409,20 @@ public:
 	398, 241
 
 	};
+	static constexpr auto outline = PixelOutline(GreenOneIzquierdaCollision);
 
 	GreenOneI(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, GreenOneIzquierdaCollision, 26), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1347,19 +1442,20 @@ public:
 	314, 251,
 	311, 254
 	};
+	static constexpr auto outline = PixelOutline(CollisionSeven);
 
 	Collision7(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionSeven, 16), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1380,19 +1476,20 @@ public:
 	365, 253,
 	361, 257
 	};
+	static constexpr auto outline = PixelOutline(CollisionEight);
 
 	Collision8(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionEight, 16), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1431,19 +1528,20 @@ public:
 	393, 486,
 	387, 497
 	};
+	static constexpr auto outline = PixelOutline(CollisionTwelve);
 
 	Collision12(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionTwelve, 52), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = DEFAULT;
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1493,8 +1591,9 @@ public:
 	430, 521,
 	420, 537
 	};
+	static constexpr auto outline = PixelOutline(CollisionThirteen);
 	Collision13(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionThirteen, 64), _listener)
+		: PhysicEntity(physics->CreatePlayfieldChain(outline), _listener)
 		, texture(_texture)
 
 	{
@@ -1514,10 +1613,6 @@ public:
 
 	void Update() override
 	{
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		if (!Hit) {  //idle anim
 			frameTimer += animationSpeed;
 			if (frameTimer >= 1.0f)
@@ -1537,6 +1632,13 @@ public:
 				currentFrame = 0; //reset frame
 			}
 		}
+	}
+
+	void Draw() override
+	{
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source;
 		if (Hit)
@@ -1583,19 +1685,20 @@ public:
 	449, 510
 
 	};
+	static constexpr auto outline = PixelOutline(SCP);
 
 	SharpedosColPunt(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, SCP, 8), _listener) 
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener) 
 		, texture(_texture)
 	{
 		collisionType = SHARPEDO;	
 	}
 
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 private:
 	Texture2D texture;
@@ -1611,18 +1714,19 @@ public:
 	185, 643,
 	175, 652
 	};
+	static constexpr auto outline = PixelOutline(CollisionThirteen);
 
 	Collision14(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionThirteen, 8), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = BOTTON1;
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1639,18 +1743,19 @@ public:
 	385, 503,
 	370, 497
 	};
+	static constexpr auto outline = PixelOutline(CollisionThirteen);
 
 	Collision18(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionThirteen, 8), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = BOTTONDERECHO;
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1667,18 +1772,19 @@ public:
 	283, 428,
 	260, 428
 	};
+	static constexpr auto outline = PixelOutline(CollisionCentralBotton);
 
 	Collision17(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionCentralBotton, 8), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = BOTTONCENTRAL;
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1702,18 +1808,19 @@ public:
 	209, 450,
 	203, 451
 	};
+	static constexpr auto outline = PixelOutline(CollisionPuntuacionCyndaquil);
 
 	Collision16(ModulePhysics* physics, int _x, int _y, Module* _listener, Texture2D _texture)
-		: PhysicEntity(physics->CreateChain(0, 0, CollisionPuntuacionCyndaquil, 22), _listener)
+		: PhysicEntity(physics->CreateChain(0, 0, outline), _listener)
 		, texture(_texture)
 	{
 		collisionType = CYNDAQUIL;
 	}
-	void Update() override
+	void Draw() override
 	{
 		int x, y;
-		body->GetPhysicPosition(x, y);
-		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetRotation() * RAD2DEG, 1.0f, WHITE);
+		body->GetDrawPosition(x, y);
+		DrawTextureEx(texture, Vector2{ (float)x, (float)y }, body->GetDrawRotation() * RAD2DEG, 1.0f, WHITE);
 	}
 
 private:
@@ -1750,10 +1857,6 @@ public:
 	}
 
 	void Update() override {
-		int x, y;
-		body->GetPhysicPosition(x, y);
-		Vector2 position{ (float)x, (float)y };
-
 		if (isRotating) {
 
 			frameTimer += animationSpeed;
@@ -1767,7 +1870,12 @@ public:
 				}
 			}
 		}
+	}
 
+	void Draw() override {
+		int x, y;
+		body->GetDrawPosition(x, y);
+		Vector2 position{ (float)x, (float)y };
 
 		Rectangle source;
 		if (isRotating) {
@@ -1808,9 +1916,9 @@ public:
 		letterVisible = true;
 	}
 
-	void Update() override {
+	void Draw() override {
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetDrawPosition(x, y);
 		Vector2 position{ (float)x, (float)y };
 
 		// Dibuja la letra solo si está activada
@@ -1842,9 +1950,9 @@ public:
 		letterVisible2 = true;
 	}
 
-	void Update() override {
+	void Draw() override {
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetDrawPosition(x, y);
 		Vector2 position{ (float)x, (float)y };
 
 		if (letterVisible2) {
@@ -1875,9 +1983,9 @@ public:
 		letterVisible3 = true;
 	}
 
-	void Update() override {
+	void Draw() override {
 		int x, y;
-		body->GetPhysicPosition(x, y);
+		body->GetDrawPosition(x, y);
 		Vector2 position{ (float)x, (float)y };
 
 		if (letterVisible3) {
@@ -1897,6 +2005,7 @@ private:
 ModuleGame::ModuleGame(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
 	ray_on = false;
+	ray_hit = 0;
 	sensed = false;
 }
 
@@ -1909,55 +2018,55 @@ bool ModuleGame::Start()
 	LOG("Loading Intro assets");
 	bool ret = true;
 
-	App->renderer->camera.x = App->renderer->camera.y = 0;
-
-	circle = LoadTexture("Assets/pokeballAnim.png"); 
-
-	spring = LoadTexture("Assets/animMuelle.png");
-
-	leftPad = LoadTexture("Assets/leftFlipper.png");
+	if (App->renderer != NULL)
+	{
+		App->renderer->camera.x = App->renderer->camera.y = 0;
+	}
+
+	// Decoded on the job system, uploaded by Finish()
+	App->assets->RequestTexture("Assets/pokeballAnim.png", &circle);
+	App->assets->RequestTexture("Assets/animMuelle.png", &spring);
+	App->assets->RequestTexture("Assets/leftFlipper.png", &leftPad);
+	App->assets->RequestTexture("Assets/RightFlipper.png", &rightPad);
+	App->assets->RequestTexture("Assets/chinchouAnim2.png", &chinchou);
+	App->assets->RequestTexture("Assets/TrianguloIzqAnim.png", &trianguloizq);
+	App->assets->RequestTexture("Assets/TrianguloDerAnim.png", &trianguloder);
+	App->assets->RequestTexture("Assets/GulpinAnim.png", &gulpin);
+	App->assets->RequestTexture("Assets/nuzleaf.png", &nuzleaf);
+	App->assets->RequestTexture("Assets/wishcash.png", &wishcash);
+	App->assets->RequestTexture("Assets/cyndaquil.png", &cyndaquil);
+	App->assets->RequestTexture("Assets/sharpedo.png", &sharpedo);
+	App->assets->RequestTexture("Assets/pikachu.png", &pikachu);
+	App->assets->RequestTexture("Assets/pichu.png", &pichu);
+	App->assets->RequestTexture("Assets/Latios.png", &latios);
+	App->assets->RequestTexture("Assets/redCircle.png", &puntorojo);
+	App->assets->RequestTexture("Assets/puertarotante.png", &puertarotante);
+	App->assets->RequestTexture("Assets/Gameover.png", &gameOverTexture);
+	App->assets->RequestFx("Assets/Po.wav", &default_fx);
+	App->assets->RequestFx("Assets/Diri.WAV", &bonus_fx);
+	App->assets->RequestFx("Assets/Saver.WAV", &saver_fx);
+
+	App->assets->Finish();
 
-	rightPad = LoadTexture("Assets/RightFlipper.png");
-
-	chinchou = LoadTexture("Assets/chinchouAnim2.png");
-
-	trianguloizq = LoadTexture("Assets/TrianguloIzqAnim.png");  
-
-	trianguloder = LoadTexture("Assets/TrianguloDerAnim.png");
-
-	gulpin = LoadTexture("Assets/GulpinAnim.png");
-
-	nuzleaf = LoadTexture("Assets/nuzleaf.png");
-
-	wishcash = LoadTexture("Assets/wishcash.png");
-
-	cyndaquil = LoadTexture("Assets/cyndaquil.png");
-
-	sharpedo = LoadTexture("Assets/sharpedo.png");
-
-	pikachu = LoadTexture("Assets/pikachu.png");
-
-	pichu = LoadTexture("Assets/pichu.png");
-
-	latios = LoadTexture("Assets/Latios.png");
-
-	puntorojo = LoadTexture("Assets/redCircle.png");
-
-	puertarotante = LoadTexture("Assets/puertarotante.png");
-	
-	gameOverTexture = LoadTexture("Assets/Gameover.png");
-
-	default_fx = App->audio->LoadFx("Assets/Po.wav");
-	bonus_fx = App->audio->LoadFx("Assets/Diri.WAV");
-	saver_fx = App->audio->LoadFx("Assets/Saver.WAV");
 	backgroundMusic = LoadMusicStream("Assets/19-Red-Table.ogg");
 
 	App->fontsModule->LoadFontTexture("Assets/Fonts32x16.png", '0',16);
 
+	balls.reserve(BALL_POOL_SIZE);
+	parked_balls.reserve(BALL_POOL_SIZE);
+	for (int i = 0; i < BALL_POOL_SIZE; ++i)
+	{
+		balls.push_back(new Circle(App->physics, this, circle));
+		parked_balls.push_back(balls.back());
+	}
+
 	PlayMusicStream(backgroundMusic);
 	entities.emplace_back(new LeftPad(App->physics,215,940, this, leftPad));
+	controls.push_back(entities.back());
 	entities.emplace_back(new RightPad(App->physics,360,940, this, rightPad));
+	controls.push_back(entities.back());
 	entities.emplace_back(new Spring(App->physics,SCREEN_WIDTH - 30, SCREEN_HEIGHT - 100, 30, 50, this, spring));
+	controls.push_back(entities.back());
 	entities.emplace_back(new Chinchou(App->physics, 358, 320, this, chinchou));
 	entities.emplace_back(new Chinchou(App->physics, 306, 371, this, chinchou));
 	entities.emplace_back(new Chinchou(App->physics, 377, 392, this, chinchou));
@@ -1995,9 +2104,15 @@ bool ModuleGame::Start()
 	entities.emplace_back(new Collision17(App->physics, 0, 0, this, botton1)); // Para meter colision puntuacion boton central
 	entities.emplace_back(new Collision18(App->physics, 0, 0, this, botton1)); // Para meter colision puntuacion boton derecho
 	
-	entities.emplace_back(new Latios(App->physics, 0, 740, this, latios, 5));
+	SpawnLatios();
 
-	
+	PhysicsWorldStats stats = App->physics->GetWorldStats();
+	LOG("Table built: %d bodies, %d broad-phase proxies, %d contacts", stats.bodies, stats.proxies, stats.contacts);
+
+	PhysicsChainStats chain_stats = App->physics->GetChainStats();
+	LOG("Wall outlines: %d chains, %d edges traced, %d after simplifying (%.2f pixels off at most)",
+		chain_stats.chains, chain_stats.edges_before, chain_stats.edges_after, chain_stats.max_deviation);
+	App->physics->CheckChainClearance(BALL_RADIUS);
 
 	return ret;
 }
@@ -2017,23 +2132,32 @@ bool ModuleGame::CleanUp()
 	UnloadTexture(pichu);
 	UnloadTexture(puertarotante);
 	UnloadTexture(latios);
+
+	for (Circle* ball : balls)
+		delete ball;
+	balls.clear();
+
 	return true;
 }
 
 // Update: draw background
 update_status ModuleGame::Update()
 {
-	UpdateMusicStream(backgroundMusic);
-	if(IsKeyPressed(KEY_SPACE))
+	if (App->audio->IsEnabled())
 	{
-		ray_on = !ray_on;
-		ray.x = GetMouseX();
-		ray.y = GetMouseY();
+		UpdateMusicStream(backgroundMusic);
 	}
 
-	DrawTexture(recuadroTexture, 10, 10, WHITE);
+	const FrameInput& input = App->input->GetFrameInput();
 
-	if (IsKeyPressed(KEY_R) && gameOver) {
+	if(input.IsPressed(BUTTON_RAY))
+	{
+		ray_on = !ray_on;
+		ray.x = input.mouse_x;
+		ray.y = input.mouse_y;
+	}
+
+	if (input.IsPressed(BUTTON_RESTART) && gameOver) {
 
 		for (PhysicEntity* entity : entities) {
 			if (entity->GetCollisionType() == PUNTOROJO && entity->letterVisible) {
@@ -2050,29 +2174,26 @@ update_status ModuleGame::Update()
 		lives = 3;
 		previousScore = suma; 
 		suma = 0;
-		entities.emplace_back(new Latios(App->physics, 0, 740, this, latios, 5));
+		SpawnLatios();
 		gameOver = false;
 
 	}
 
 	if (!gameOver) {
-		if (IsKeyPressed(KEY_ONE)) {
-			entities.emplace_back(new Circle(App->physics, GetMousePosition().x, GetMousePosition().y, this, circle));
+		if (input.IsPressed(BUTTON_SPAWN_BALL)) {
+			SpawnBall(input.mouse_x, input.mouse_y);
 		}
 
-		std::vector<PhysicEntity*> newEntities;
-
-		for (auto it = entities.begin(); it != entities.end(); ++it) {
-			Latios* latios = dynamic_cast<Latios*>(*it);
+		for (PhysicEntity* entity : entities) {
+			Latios* latios = dynamic_cast<Latios*>(entity);
 
 			if (latios != nullptr) {
 				if (latios->hasToSpawnBall && !latios->pokeballSpawned) {
-					newEntities.emplace_back(new Circle(App->physics, SCREEN_WIDTH - 45, 790, this, circle));
+					SpawnBall(SCREEN_WIDTH - 45, 790);
 					latios->pokeballSpawned = true;
 				}
 			}
 		}
-		entities.insert(entities.end(), newEntities.begin(), newEntities.end());
 
 		bool allLettersVisible = true;
 
@@ -2096,71 +2217,110 @@ update_status ModuleGame::Update()
 			lifeAdded = true;
 		}
 
-		if (IsKeyPressed(KEY_TWO))
+		if (input.IsPressed(BUTTON_DRAIN_BALLS))
 		{
-			for (auto it = entities.begin(); it != entities.end(); )
-			{
-				if (dynamic_cast<Circle*>(*it) != nullptr)
-				{
-					it = entities.erase(it);
-				}
-				else
-				{
-					++it;
-				}
-			}
+			DrainBalls();
 		}
 
-		if (IsKeyPressed(KEY_THREE)) {
-			entities.emplace_back(new Latios(App->physics, 0, 740, this, latios, 5));
+		if (input.IsPressed(BUTTON_SPAWN_LATIOS)) {
+			SpawnLatios();
 		}
 	}
 
 	if (lives > 0) {
 		if (deleteCircles) {
-			entities.emplace_back(new Latios(App->physics, 0, 740, this, latios, 5));
+			SpawnLatios();
 			lives--;			
 		}
 	}
 	
-	// Prepare for raycast ------------------------------------------------------
-	
-	vec2i mouse;
-	mouse.x = GetMouseX();
-	mouse.y = GetMouseY();
-	int ray_hit = ray.DistanceTo(mouse);
-
-	vec2f normal(0.0f, 0.0f);
+	{
+		PROFILE_SCOPE("Entity Update");
+		for (PhysicEntity* entity : entities)
+		{
+			entity->Update();
+		}
+	}
 
-	// All draw functions ------------------------------------------------------
+	if (suma > highscore) {
+		highscore = suma;
+	}
 
+	if (lives <= 0) {
+		lives = 0;
+		gameOver = true;
+	}
 
-	for (PhysicEntity* entity : entities)
+	// Raycast while the world is not stepping, Draw only shows the result
+	if (ray_on)
 	{
-		entity->Update();
-		if (ray_on)
+		vec2i mouse;
+		mouse.x = input.mouse_x;
+		mouse.y = input.mouse_y;
+		ray_hit = ray.DistanceTo(mouse);
+		ray_normal = vec2f(0.0f, 0.0f);
+
+		for (PhysicEntity* entity : entities)
 		{
-			int hit = entity->RayHit(ray, mouse, normal);
+			int hit = entity->RayHit(ray, mouse, ray_normal);
 			if (hit >= 0)
 			{
 				ray_hit = hit;
 			}
 		}
 	}
+
+	return UPDATE_CONTINUE;
+}
+
+// Drawn after ModulePhysics::PostUpdate took the snapshot, physics may be stepping meanwhile
+update_status ModuleGame::PostUpdate()
+{
+	// Nothing to draw when running the simulation without a window
+	if (App->IsHeadless() == false)
+	{
+		Draw();
+	}
+
+	return UPDATE_CONTINUE;
+}
+
+void ModuleGame::Draw()
+{
+	DrawTexture(recuadroTexture, 10, 10, WHITE);
+
+	// All draw functions ------------------------------------------------------
+
+	{
+		PROFILE_SCOPE("Entity Draw");
+		for (PhysicEntity* entity : entities)
+		{
+			entity->Draw();
+		}
+
+		for (PhysBody* ball : App->physics->GetCircles(POKEBALL))
+		{
+			ball->entity->Draw();
+		}
+	}
 	
 
 	// ray -----------------
 	if (ray_on == true)
 	{
+		vec2i mouse;
+		mouse.x = App->input->GetFrameInput().mouse_x;
+		mouse.y = App->input->GetFrameInput().mouse_y;
+
 		vec2f destination((float)(mouse.x - ray.x), (float)(mouse.y - ray.y));
 		destination.Normalize();
 		destination *= (float)ray_hit;
 
 		DrawLine(ray.x, ray.y, (int)(ray.x + destination.x), (int)(ray.y + destination.y), RED);
 
-		if (normal.x != 0.0f)
+		if (ray_normal.x != 0.0f)
 		{
-			DrawLine((int)(ray.x + destination.x), (int)(ray.y + destination.y), (int)(ray.x + destination.x + normal.x * 25.0f), (int)(ray.y + destination.y + normal.y * 25.0f), Color{ 100, 255, 100, 255 });
+			DrawLine((int)(ray.x + destination.x), (int)(ray.y + destination.y), (int)(ray.x + destination.x + ray_normal.x * 25.0f), (int)(ray.y + destination.y + ray_normal.y * 25.0f), Color{ 100, 255, 100, 255 });
 		}
 	}
 
@@ -2169,19 +2329,143 @@ update_status ModuleGame::Update()
 	App->fontsModule->DrawText(313, 77, TextFormat("%d", highscore), WHITE);
 	App->fontsModule->DrawText(465, 77, TextFormat("%d", previousScore), WHITE);
 
-	if (suma > highscore) {
-		highscore = suma;
-	}
-
-	if (lives <= 0) {
-		lives = 0;
-		gameOver = true;
+	if (gameOver) {
 		DrawTexture(gameOverTexture, SCREEN_WIDTH / 2 - gameOverTexture.width / 2,
 			SCREEN_HEIGHT / 2 - gameOverTexture.height / 2, WHITE);
 	}
+}
 
+void ModuleGame::ApplyTickInput(const TickInput& input)
+{
+	for (PhysicEntity* control : controls)
+	{
+		control->ApplyInput(input);
+	}
+}
 
-	return UPDATE_CONTINUE;
+void ModuleGame::SpawnBall(int x, int y)
+{
+	uint64 allocations = GetHeapAllocations();
+
+	Circle* ball = NULL;
+	if (parked_balls.empty() == false)
+	{
+		ball = parked_balls.back();
+		parked_balls.pop_back();
+	}
+	else
+	{
+		LOG_WARNING("Ball pool exhausted, growing it to %d balls", (int)balls.size() + 1);
+		ball = new Circle(App->physics, this, circle);
+		balls.push_back(ball);
+	}
+
+	ball->Spawn(x, y);
+	++ball_spawns;
+
+	ball_allocations += GetHeapAllocations() - allocations;
+}
+
+void ModuleGame::DrainBalls()
+{
+	const std::vector<PhysBody*>& in_play = App->physics->GetCircles(POKEBALL);
+	if (in_play.empty())
+		return;
+
+	uint64 allocations = GetHeapAllocations();
+
+	// Parking unregisters the body, always take the last one
+	while (in_play.empty() == false)
+	{
+		Circle* ball = static_cast<Circle*>(in_play.back()->entity);
+		ball->Park();
+		parked_balls.push_back(ball);
+	}
+	++ball_drains;
+
+	ball_allocations += GetHeapAllocations() - allocations;
+}
+
+struct GameState
+{
+	int suma;
+	int highscore;
+	int previousScore;
+	int lives;
+	bool gameOver;
+	bool lifeAdded;
+	bool deleteCircles;
+};
+
+void ModuleGame::SaveState(std::vector<uint8>& state) const
+{
+	GameState game = { suma, highscore, previousScore, lives, gameOver, lifeAdded, deleteCircles };
+	PutState(state, game);
+
+	PutState(state, (int)entities.size());
+	for (const PhysicEntity* entity : entities)
+		entity->SaveState(state);
+
+	// The pool order decides which ball the next spawn takes
+	PutState(state, (int)balls.size());
+	PutState(state, (int)parked_balls.size());
+	for (const Circle* ball : parked_balls)
+		PutState(state, (int)(std::find(balls.begin(), balls.end(), ball) - balls.begin()));
+}
+
+bool ModuleGame::LoadState(const uint8*& in, const uint8* end)
+{
+	GameState game;
+	int entity_count = 0;
+	if (GetState(in, end, game) == false || GetState(in, end, entity_count) == false || entity_count != (int)entities.size())
+	{
+		LOG_ERROR("Game state does not match the entities in play");
+		return false;
+	}
+
+	suma = game.suma;
+	highscore = game.highscore;
+	previousScore = game.previousScore;
+	lives = game.lives;
+	gameOver = game.gameOver;
+	lifeAdded = game.lifeAdded;
+	deleteCircles = game.deleteCircles;
+
+	for (PhysicEntity* entity : entities)
+	{
+		if (entity->LoadState(in, end) == false)
+			return false;
+	}
+
+	int ball_count = 0, parked_count = 0;
+	if (GetState(in, end, ball_count) == false || ball_count != (int)balls.size() || GetState(in, end, parked_count) == false)
+		return false;
+
+	parked_balls.clear();
+	for (int i = 0; i < parked_count; ++i)
+	{
+		int index = 0;
+		if (GetState(in, end, index) == false || index < 0 || index >= ball_count)
+			return false;
+		parked_balls.push_back(balls[index]);
+	}
+
+	return true;
+}
+
+void ModuleGame::SpawnLatios()
+{
+	for (PhysicEntity* entity : entities)
+	{
+		Latios* gone = dynamic_cast<Latios*>(entity);
+		if (gone != nullptr && gone->IsMarkedForDeletion())
+		{
+			gone->Reset(0);
+			return;
+		}
+	}
+
+	entities.emplace_back(new Latios(App->physics, 0, 740, this, latios, 5));
 }
 
 void ModuleGame::OnCollision(PhysBody* bodyA, PhysBody* bodyB)
@@ -2261,6 +2545,7 @@ void ModuleGame::OnCollision(PhysBody* bodyA, PhysBody* bodyB)
 			}
 			if (bodyA == entities[i]->body && entities[i]->GetCollisionType() == SENSOR && entities[i]->GetSensor() == DELETE) {
 				App->audio->PlayFx(saver_fx);
+				LOG_DEBUG("Ball drained, %d lives left", lives);
 				deleteCircles = true;
 				break;
 			}
@@ -2280,19 +2565,7 @@ void ModuleGame::OnCollision(PhysBody* bodyA, PhysBody* bodyB)
 	}
 
 	if (deleteCircles || gameOver) {
-
-		for (auto it = entities.begin(); it != entities.end(); )
-		{
-
-			if (dynamic_cast<Circle*>(*it) != nullptr)
-			{
-				it = entities.erase(it);
-			}
-			else
-			{
-				++it;
-			}
-		}
+		DrainBalls();
 	}
 	if (hascollisionedwithtrianguloizq) {
 		for (int i = 0; i < entities.size(); ++i) {
@@ -11,6 +11,8 @@
 
 class PhysBody;
 class PhysicEntity;
+class Circle;
+struct TickInput;
 
 enum CollisionType
 {
@@ -46,7 +48,8 @@ enum BodyType {
 
 enum CircleType {
 	POKEBALL,
-	ELSE
+	ELSE,
+	CIRCLE_TYPE_COUNT
 };
 
 enum SensorType {
@@ -62,13 +65,36 @@ public:
 
 	bool Start();
 	update_status Update();
+	update_status PostUpdate();
 	bool CleanUp();
 	void OnCollision(PhysBody* bodyA, PhysBody* bodyB);
 	void GetType();
 
+	// Called by ModulePhysics before every Step, possibly on the physics thread
+	void ApplyTickInput(const TickInput& input);
+
+	// Balls come from a pool created in Start, draining parks them again
+	void SpawnBall(int x, int y);
+	void DrainBalls();
+	void SpawnLatios();
+
+	// Score, lives, entity and ball pool state for snapshots. Loading it
+	// comes after ModulePhysics restored the world, with the same entities
+	void SaveState(std::vector<uint8>& state) const;
+	bool LoadState(const uint8*& in, const uint8* end);
+
+private:
+	void Draw();
+
 public:
 
 	std::vector<PhysicEntity*> entities;
+	std::vector<PhysicEntity*> controls;	// Flippers and plunger, driven by ApplyTickInput
+	std::vector<Circle*> balls;				// Ball pool, in play or parked
+	std::vector<Circle*> parked_balls;		// Free part of the pool, spawns pop from the back
+	int ball_spawns = 0;
+	int ball_drains = 0;
+	uint64 ball_allocations = 0;			// Heap allocations made by spawns and drains, 0 once the pool is warm
 	
 	bool lifeAdded = false;
 	bool allConditionsMet = false;
@@ -127,4 +153,6 @@ public:
 	Music backgroundMusic;
 	vec2<int> ray;
 	bool ray_on;
+	int ray_hit;
+	vec2<float> ray_normal;
 };
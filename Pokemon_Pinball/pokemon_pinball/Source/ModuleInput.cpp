@@ -0,0 +1,289 @@
+// ----------------------------------------------------
+// ModuleInput.cpp
+// Samples the table controls every frame and hands them
+// to the physics ticks stamped with the tick they start at
+// ----------------------------------------------------
+
+#include "Globals.h"
+#include "Application.h"
+#include "ModuleInput.h"
+#include "ModulePhysics.h"
+#include "ModuleGame.h"
+#include "Replay.h"
+#include "Timer.h"
+
+// Keyboard key for every GameButton bit, in bit order
+static const int button_keys[] = { KEY_R, KEY_ONE, KEY_TWO, KEY_THREE, KEY_SPACE, KEY_F1, KEY_F3, KEY_F4, KEY_F5, KEY_F6 };
+
+ModuleInput::ModuleInput(Application* app, bool start_enabled) : Module(app, start_enabled)
+{
+	frame_input = { { false, false, false }, 0, 0, 0, 0, 0 };
+	latched_input = frame_input.controls;
+
+	recorder = NULL;
+	replay = NULL;
+	replay_finished = false;
+	was_pipelined = false;
+	frame_first_tick = 0;
+	next_keyframe_tick = 0;
+	checked_ticks = 0;
+	hash_base_tick = 0;
+	first_divergent_tick = -1;
+}
+
+// Destructor
+ModuleInput::~ModuleInput()
+{}
+
+// Runs before ModulePhysics::PreUpdate, so a change seen now already
+// applies to the first tick of this frame instead of the next frame
+update_status ModuleInput::PreUpdate()
+{
+	frame_first_tick = App->physics->GetNextTick();
+
+	// Keyframes go on a frame boundary, before this frame's input
+	if (recorder != NULL && frame_first_tick >= next_keyframe_tick)
+	{
+		std::vector<uint8> state;
+		App->SaveSnapshot(state);
+		recorder->AddKeyframe(state);
+		next_keyframe_tick = frame_first_tick + REPLAY_KEYFRAME_INTERVAL;
+	}
+
+	FrameInput input = frame_input;
+
+	if (replay != NULL)
+	{
+		ReplayFrame frame;
+		if (replay->NextFrame(frame))
+		{
+			input.controls = frame.controls;
+			input.buttons = frame.buttons;
+			input.mouse_x = frame.mouse_x;
+			input.mouse_y = frame.mouse_y;
+			App->physics->SetNextFrameTicks(frame.ticks);
+		}
+		else
+		{
+			// Out of frames, the world holds still
+			replay_finished = true;
+			App->physics->SetNextFrameTicks(0);
+		}
+	}
+	else
+	{
+		SampleLive(input);
+	}
+
+	input.pressed = input.buttons & ~frame_input.buttons;
+	input.released = frame_input.buttons & ~input.buttons;
+
+	if ((input.controls == frame_input.controls) == false)
+	{
+		// Ticks before GetNextTick() are already stepped or in flight, the
+		// earliest sub-step this press can still reach is the next one
+		InputCommand command = { frame_first_tick, Timer::GetTicks(), input.controls };
+
+		std::lock_guard<std::mutex> lock(command_mutex);
+		commands.push_back(command);
+	}
+
+	frame_input = input;
+
+	return UPDATE_CONTINUE;
+}
+
+// After ModulePhysics::PreUpdate stepped this frame's ticks
+update_status ModuleInput::Update()
+{
+	if (recorder != NULL)
+	{
+		ReplayFrame frame = { (int)(App->physics->GetNextTick() - frame_first_tick), frame_input.controls,
+			frame_input.buttons, frame_input.mouse_x, frame_input.mouse_y };
+		recorder->AddFrame(frame);
+
+		App->physics->TakeTickHashes(tick_hashes);
+		for (uint32 hash : tick_hashes)
+			recorder->AddTickHash(hash);
+		tick_hashes.clear();
+	}
+	else if (replay != NULL)
+	{
+		CheckTickHashes();
+	}
+
+	return UPDATE_CONTINUE;
+}
+
+void ModuleInput::SampleLive(FrameInput& input) const
+{
+	input.controls.left_flipper = IsKeyDown(KEY_A);
+	input.controls.right_flipper = IsKeyDown(KEY_D);
+	input.controls.plunger = IsKeyDown(KEY_S);
+
+	input.buttons = 0;
+	for (int i = 0; i < (int)(sizeof(button_keys) / sizeof(button_keys[0])); ++i)
+	{
+		if (IsKeyDown(button_keys[i])) input.buttons |= 1 << i;
+	}
+	if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) input.buttons |= BUTTON_MOUSE_LEFT;
+
+	input.mouse_x = GetMouseX();
+	input.mouse_y = GetMouseY();
+}
+
+TickInput ModuleInput::LatchTick(uint64 tick)
+{
+	std::lock_guard<std::mutex> lock(command_mutex);
+
+	while (commands.empty() == false && commands.front().tick <= tick)
+	{
+		static TimerAccumulator* latency = TimerAccumulator::Get("Input Latency");
+		if (latency != NULL) latency->Add(Timer::GetTicks() - commands.front().time);
+
+		latched_input = commands.front().input;
+		commands.pop_front();
+	}
+
+	return latched_input;
+}
+
+void ModuleInput::StartRecording()
+{
+	if (recorder != NULL || replay != NULL)
+		return;
+
+	was_pipelined = App->physics->IsPipelined();
+	App->physics->SetPipelined(false);
+	App->physics->SetTickHashing(true);
+
+	ReplaySettings settings;
+	settings.tick_rate = App->physics->GetTickRate();
+	settings.substeps = App->physics->GetSubSteps();
+	settings.adaptive_iterations = App->physics->IsAdaptiveIterations();
+	settings.ball_bullet = App->physics->IsBallBullet();
+	settings.toi_budget = App->physics->GetTOIBudget();
+	settings.bake_playfield = App->physics->IsPlayfieldBaking();
+	settings.chain_tolerance = App->physics->GetChainTolerance();
+	settings.contact_solver = App->physics->GetContactSolver();
+
+	recorder = new ReplayWriter();
+	recorder->Begin(settings);
+
+	// The first keyframe holds the state the recording starts from
+	next_keyframe_tick = 0;
+
+	LOG("Recording replay");
+}
+
+bool ModuleInput::StopRecording(const char* path)
+{
+	if (recorder == NULL)
+		return false;
+
+	bool ok = recorder->Save(path);
+
+	delete recorder;
+	recorder = NULL;
+
+	App->physics->SetTickHashing(false);
+	App->physics->SetPipelined(was_pipelined);
+
+	return ok;
+}
+
+void ModuleInput::StartReplay(ReplayReader* reader)
+{
+	if (recorder != NULL || replay != NULL)
+		return;
+
+	was_pipelined = App->physics->IsPipelined();
+	App->physics->SetPipelined(false);
+	App->physics->SetTickHashing(true);
+
+	replay = reader;
+	replay_finished = false;
+
+	// Recordings started mid-game begin with the keyframe of that moment
+	SeekReplay(0);
+}
+
+bool ModuleInput::SeekReplay(uint64 tick)
+{
+	if (replay == NULL)
+		return false;
+
+	const ReplayKeyframe* keyframe = replay->Seek(tick);
+	if (keyframe == NULL)
+		return false;
+
+	if (App->LoadSnapshot(keyframe->state.data(), keyframe->state.size()) == false)
+		return false;
+
+	replay_finished = false;
+	hash_base_tick = keyframe->tick;
+	checked_ticks = 0;
+	first_divergent_tick = -1;
+	tick_hashes.clear();
+
+	return true;
+}
+
+void ModuleInput::CheckTickHashes()
+{
+	App->physics->TakeTickHashes(tick_hashes);
+
+	for (uint32 hash : tick_hashes)
+	{
+		uint64 tick = hash_base_tick + checked_ticks;
+		if (tick < replay->GetTickCount() && hash != replay->GetTickHash(tick) && first_divergent_tick < 0)
+		{
+			first_divergent_tick = (int64_t)tick;
+			LOG_WARNING("Replay diverged at tick %llu", (unsigned long long)tick);
+		}
+		++checked_ticks;
+	}
+
+	tick_hashes.clear();
+}
+
+struct CommandState
+{
+	uint64 tick;
+	TickInput input;
+};
+
+void ModuleInput::SaveState(std::vector<uint8>& state) const
+{
+	PutState(state, latched_input);
+	PutState(state, frame_input);
+
+	PutState(state, (int)commands.size());
+	for (const InputCommand& command : commands)
+	{
+		CommandState command_state = { command.tick, command.input };
+		PutState(state, command_state);
+	}
+}
+
+bool ModuleInput::LoadState(const uint8*& in, const uint8* end)
+{
+	int count = 0;
+	if (GetState(in, end, latched_input) == false || GetState(in, end, frame_input) == false || GetState(in, end, count) == false)
+		return false;
+
+	std::lock_guard<std::mutex> lock(command_mutex);
+	commands.clear();
+
+	for (int i = 0; i < count; ++i)
+	{
+		CommandState command_state;
+		if (GetState(in, end, command_state) == false)
+			return false;
+
+		// Latency is measured from the restore, the original sample time means nothing now
+		commands.push_back({ command_state.tick, Timer::GetTicks(), command_state.input });
+	}
+
+	return true;
+}
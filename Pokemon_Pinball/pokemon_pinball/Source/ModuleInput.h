@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Module.h"
+#include "Globals.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class ReplayWriter;
+class ReplayReader;
+
+// Controls that drive the simulation, latched once per physics tick
+struct TickInput
+{
+	bool left_flipper;
+	bool right_flipper;
+	bool plunger;
+
+	bool operator==(const TickInput& other) const
+	{
+		return left_flipper == other.left_flipper && right_flipper == other.right_flipper && plunger == other.plunger;
+	}
+};
+
+// Every other key the game reacts to, as bits of FrameInput::buttons
+enum GameButton
+{
+	BUTTON_RESTART = 1 << 0,		// R
+	BUTTON_SPAWN_BALL = 1 << 1,		// 1, at the mouse
+	BUTTON_DRAIN_BALLS = 1 << 2,	// 2
+	BUTTON_SPAWN_LATIOS = 1 << 3,	// 3
+	BUTTON_RAY = 1 << 4,			// Space
+	BUTTON_DEBUG = 1 << 5,			// F1
+	BUTTON_DEBUG_AABBS = 1 << 6,	// F3
+	BUTTON_DEBUG_JOINTS = 1 << 7,	// F4
+	BUTTON_DEBUG_CONTACTS = 1 << 8,	// F5
+	BUTTON_DEBUG_CENTERS = 1 << 9,	// F6
+	BUTTON_MOUSE_LEFT = 1 << 10
+};
+
+// All the input of a frame, sampled once by ModuleInput. Game code reads this instead of raylib
+struct FrameInput
+{
+	TickInput controls;
+	uint32 buttons;		// Held
+	uint32 pressed;		// Went down this frame
+	uint32 released;	// Went up this frame
+	int mouse_x;
+	int mouse_y;
+
+	bool IsDown(GameButton button) const { return (buttons & button) != 0; }
+	bool IsPressed(GameButton button) const { return (pressed & button) != 0; }
+	bool IsReleased(GameButton button) const { return (released & button) != 0; }
+};
+
+class ModuleInput : public Module
+{
+public:
+
+	ModuleInput(Application* app, bool start_enabled = true);
+
+	// Destructor
+	virtual ~ModuleInput();
+
+	update_status PreUpdate();
+	update_status Update();
+
+	// Input as sampled this frame, for game logic, animations and debug tools
+	const FrameInput& GetFrameInput() const { return frame_input; }
+
+	// Controls in effect for a physics tick, called by ModulePhysics right before each Step.
+	// Ticks must be asked for in order, commands stamped up to tick are consumed.
+	TickInput LatchTick(uint64 tick);
+
+	// Recording stores every frame's input and tick count plus a hash of the world after
+	// every tick. Both recording and replay step physics on the main thread: pipelined
+	// ticks run after the game update instead of before it, which a replay could not match
+	void StartRecording();
+	bool StopRecording(const char* path);
+	bool IsRecording() const { return recorder != NULL; }
+
+	// Frames come from the reader instead of the keyboard until it runs out.
+	// The reader is owned by the caller and must outlive the replay
+	void StartReplay(ReplayReader* reader);
+	// Restores the last keyframe at or before tick, false when there is none
+	bool SeekReplay(uint64 tick);
+	bool IsReplaying() const { return replay != NULL; }
+	bool IsReplayFinished() const { return replay_finished; }
+	// First tick whose hash differs from the recording, -1 while they all match
+	int64_t GetFirstDivergentTick() const { return first_divergent_tick; }
+	uint64 GetCheckedTicks() const { return checked_ticks; }
+
+	// Controls latched and still queued, part of Application::SaveSnapshot
+	void SaveState(std::vector<uint8>& state) const;
+	bool LoadState(const uint8*& in, const uint8* end);
+
+private:
+
+	void SampleLive(FrameInput& input) const;
+	void CheckTickHashes();
+
+	// A change of the controls and the first tick it applies to
+	struct InputCommand
+	{
+		uint64 tick;
+		uint64 time;		// Timer::GetTicks() when it was sampled
+		TickInput input;
+	};
+
+	FrameInput frame_input;
+	TickInput latched_input;
+
+	// Written on the main thread, read on the physics thread when pipelined
+	std::mutex command_mutex;
+	std::deque<InputCommand> commands;
+
+	// Recording and replay
+	ReplayWriter* recorder;
+	ReplayReader* replay;
+	bool replay_finished;
+	bool was_pipelined;
+	uint64 frame_first_tick;	// GetNextTick() when the frame started
+	uint64 next_keyframe_tick;
+	uint64 checked_ticks;		// Ticks whose hash was compared, starting at hash_base_tick
+	uint64 hash_base_tick;
+	int64_t first_divergent_tick;
+	std::vector<uint32> tick_hashes;
+};
@@ -2,7 +2,11 @@
 #include "Application.h"
 #include "ModuleRender.h"
 #include "ModulePhysics.h"
-
+#include "ChainSimplify.h"
+#include "ModuleInput.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "StateBuffer.h"
 
 #include "p2Point.h"
 
@@ -13,7 +17,33 @@ ModulePhysics::ModulePhysics(Application* app, bool start_enabled) : Module(app,
 	world = NULL;
 	mouse_joint = NULL;
 	debug = false;
-	
+	debug_overlays = 0;
+	bake_playfield = PHYSICS_BAKE_PLAYFIELD;
+	playfield = NULL;
+	chain_tolerance = PHYSICS_CHAIN_TOLERANCE;
+	ball_bullet = PHYSICS_BALL_BULLET;
+	toi_budget = PHYSICS_TOI_BUDGET;
+	tunneling_stats = {};
+	substeps = PHYSICS_SUBSTEPS;
+	adaptive_iterations = PHYSICS_ADAPTIVE_ITERATIONS;
+	budget_stats = {};
+	parallel_islands = PHYSICS_PARALLEL_ISLANDS;
+	contact_solver = PHYSICS_WIDE_CONTACTS ? b2_contactSolverWide : b2_contactSolverDefault;
+
+	SetTickRate(PHYSICS_TICK_RATE);
+	accumulator = 0.0;
+	interpolation_alpha = 0.0f;
+	tick_count = 0;
+	scheduled_ticks = 0;
+	forced_frame_ticks = -1;
+	tick_hashing = false;
+
+	pipelined = false;
+	pending_ticks = 0;
+	step_ticks = 0;
+	step_quit = false;
+	contact_event_count = 0;
+	dropped_contact_events = 0;
 }
 
 // Destructor
@@ -27,7 +57,10 @@ bool ModulePhysics::Start()
 
 	world = new b2World(b2Vec2(GRAVITY_X, -GRAVITY_Y));
 	world->SetContactListener(this);
-	
+	world->SetDebugDraw(&debug_draw);
+	world->SetTOIBudget(toi_budget);
+	if (parallel_islands) world->SetTaskExecutor(this);
+	world->SetContactSolver(contact_solver);
 
 	// needed to create joints like mouse joint
 	b2BodyDef bd;
@@ -50,29 +83,734 @@ bool ModulePhysics::Start()
 	b2FixtureDef fixture;
 	fixture.shape = &shape;
 
+	frame_timer.Start();
+
+	// Without a renderer there is nothing to overlap the physics with
+	SetPipelined(PHYSICS_PIPELINED && App->IsHeadless() == false);
 
 	return true;
 }
 
+void ModulePhysics::SetPipelined(bool enable)
+{
+	WaitStep();
+
+	if (enable && step_thread.joinable() == false)
+		step_thread = std::thread(&ModulePhysics::StepThread, this);
+
+	pipelined = enable;
+}
+
+void ModulePhysics::SetTickRate(int ticks_per_second)
+{
+	tick_rate = (ticks_per_second > 0) ? ticks_per_second : PHYSICS_TICK_RATE;
+	tick_dt = 1.0 / tick_rate;
+}
+
+// Accumulate real time and consume it in fixed ticks, so the simulation speed
+// does not depend on the display refresh rate
 update_status ModulePhysics::PreUpdate()
 {
-	world->Step(1.0f / 60.0f, 6, 2);
+	// Collect the ticks the physics thread ran while the last frame rendered
+	WaitStep();
+	DispatchContacts();
+
+	double frame_time = frame_timer.ReadSec();
+	frame_timer.Start();
+
+	// Headless has no real time to follow, every update is exactly one tick
+	if (App->IsHeadless())
+		frame_time = tick_dt;
+
+	// Never try to catch up more than PHYSICS_MAX_TICKS, a long frame just loses time
+	double max_frame_time = tick_dt * PHYSICS_MAX_TICKS;
+	if (frame_time > max_frame_time)
+		frame_time = max_frame_time;
+
+	accumulator += frame_time;
+
+	int ticks = 0;
+	while (accumulator >= tick_dt)
+	{
+		++ticks;
+		accumulator -= tick_dt;
+	}
+	if (forced_frame_ticks >= 0)
+	{
+		ticks = forced_frame_ticks;
+		forced_frame_ticks = -1;
+	}
+	scheduled_ticks += ticks;
+
+	// Pipelined ticks are started in PostUpdate, once the game is done changing the world
+	if (pipelined)
+	{
+		pending_ticks = ticks;
+	}
+	else
+	{
+		for (int i = 0; i < ticks; ++i)
+			Tick();
+	}
+
+	interpolation_alpha = (float)(accumulator / tick_dt);
+
+	return UPDATE_CONTINUE;
+}
+
+void ModulePhysics::Tick()
+{
+	SCOPED_TIMER("Physics Tick");
 
-	for(b2Contact* c = world->GetContactList(); c; c = c->GetNext())
+	for (PhysBody* pbody : tracked_bodies)
 	{
-		if(c->GetFixtureA()->IsSensor() && c->IsTouching())
+		pbody->previous_position = pbody->body->GetPosition();
+		pbody->previous_angle = pbody->body->GetAngle();
+	}
+
+	// Controls are applied per tick, so a press reaches the first Step after it was seen
+	App->scene_intro->ApplyTickInput(App->input->LatchTick(tick_count));
+
+	PhysicsStepBudget budget = ChooseStepBudget();
+	{
+		PROFILE_SCOPE("Physics Step");
+		float step_dt = (float)(tick_dt / budget.substeps);
+		for (int i = 0; i < budget.substeps; ++i)
 		{
-			b2BodyUserData data1 = c->GetFixtureA()->GetBody()->GetUserData();
-			b2BodyUserData data2 = c->GetFixtureA()->GetBody()->GetUserData();
+			world->Step(step_dt, budget.velocity_iterations, budget.position_iterations);
+			AddTOIStats();
+		}
+	}
+	++tick_count;
+
+	++budget_stats.ticks;
+	budget_stats.substeps += budget.substeps;
+	budget_stats.velocity_iterations += budget.substeps * budget.velocity_iterations;
+	budget_stats.position_iterations += budget.substeps * budget.position_iterations;
+	if (budget.velocity_iterations >= ADAPTIVE_MAX_VELOCITY_ITERATIONS)
+		++budget_stats.top_budget_ticks;
+	budget_stats.last = budget;
+
+	CheckTunneling();
+
+	if (tick_hashing)
+		tick_hashes.push_back(HashWorld());
+
+	// Sensors keep reporting every tick while something stays inside them
+	for (const SensorOverlap& overlap : sensor_overlaps)
+		RecordContact(overlap.sensor, overlap.other, b2Vec2_zero, 0.0f, CONTACT_SENSOR);
+
+	// Pipelined ticks keep buffering, the main thread dispatches in PreUpdate
+	if (pipelined == false)
+		DispatchContacts();
+}
+
+// Chain edges are one-sided, the ray only hits the side that should have stopped the ball
+class WallCrossingCallback : public b2RayCastCallback
+{
+public:
+	WallCrossingCallback() : crossed(false)
+	{}
+
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		if (fixture->GetType() != b2Shape::e_chain || fixture->IsSensor())
+			return -1.0f;
+
+		crossed = true;
+		return 0.0f;
+	}
+
+	bool crossed;
+};
+
+// Iterations only pay off with a fast ball or a pile of contacts, a quiet table gets the minimum
+PhysicsStepBudget ModulePhysics::ChooseStepBudget() const
+{
+	PhysicsStepBudget budget = {};
+	budget.substeps = substeps;
+	budget.velocity_iterations = PHYSICS_VELOCITY_ITERATIONS;
+	budget.position_iterations = PHYSICS_POSITION_ITERATIONS;
+
+	if (adaptive_iterations == false)
+		return budget;
+
+	for (const PhysBody* ball : circles[POKEBALL])
+		budget.max_ball_speed = MAX(budget.max_ball_speed, ball->body->GetLinearVelocity().Length());
+
+	for (const b2Contact* c = world->GetContactList(); c; c = c->GetNext())
+	{
+		if (c->IsTouching() && (c->GetFixtureA()->GetBody()->IsAwake() || c->GetFixtureB()->GetBody()->IsAwake()))
+			++budget.active_contacts;
+	}
 
-			PhysBody* pb1 = (PhysBody*)data1.pointer;
-			PhysBody* pb2 = (PhysBody*)data2.pointer;
-			if(pb1 && pb2 && pb1->listener)
-				pb1->listener->OnCollision(pb1, pb2);
+	float load = MAX(budget.max_ball_speed / ADAPTIVE_FAST_BALL_SPEED, (float)budget.active_contacts / ADAPTIVE_BUSY_CONTACTS);
+	load = MIN(load, 1.0f);
+
+	budget.velocity_iterations = ADAPTIVE_MIN_VELOCITY_ITERATIONS
+		+ (int)ceilf(load * (ADAPTIVE_MAX_VELOCITY_ITERATIONS - ADAPTIVE_MIN_VELOCITY_ITERATIONS));
+	budget.position_iterations = ADAPTIVE_MIN_POSITION_ITERATIONS
+		+ (int)ceilf(load * (ADAPTIVE_MAX_POSITION_ITERATIONS - ADAPTIVE_MIN_POSITION_ITERATIONS));
+
+	return budget;
+}
+
+// After every world step, a tick may run several
+void ModulePhysics::AddTOIStats()
+{
+	const b2TOIStats& toi = world->GetTOIStats();
+	tunneling_stats.toi_events += toi.events;
+	tunneling_stats.toi_substeps += toi.subSteps;
+	tunneling_stats.max_substeps = MAX(tunneling_stats.max_substeps, (int)toi.subSteps);
+	if (toi.budgetExhausted)
+		++tunneling_stats.budget_ticks;
+	tunneling_stats.held_bodies += toi.heldBodies;
+}
+
+// A ball bouncing off a wall keeps its center a radius away from it: a center
+// that went through a wall edge during the tick means the ball tunneled
+void ModulePhysics::CheckTunneling()
+{
+	++tunneling_stats.ticks;
+
+	for (PhysBody* ball : circles[POKEBALL])
+	{
+		const b2Vec2& position = ball->body->GetPosition();
+		if (b2DistanceSquared(ball->previous_position, position) < b2_linearSlop * b2_linearSlop)
+			continue;
+
+		WallCrossingCallback crossing;
+		world->RayCast(&crossing, ball->previous_position, position);
+		if (crossing.crossed)
+		{
+			++tunneling_stats.wall_penetrations;
+			LOG_DEBUG("Ball went through a wall at tick %llu, %.1f m/s", (unsigned long long)tick_count,
+				ball->body->GetLinearVelocity().Length());
 		}
 	}
+}
 
-	return UPDATE_CONTINUE;
+void ModulePhysics::SetBallBullet(bool enable)
+{
+	WaitStep();
+	ball_bullet = enable;
+
+	for (PhysBody* pbody : tracked_bodies)
+	{
+		if (IsBall(pbody))
+			pbody->body->SetBullet(enable);
+	}
+}
+
+void ModulePhysics::SetTOIBudget(int substeps)
+{
+	WaitStep();
+	toi_budget = MAX(substeps, 0);
+
+	if (world != NULL)
+		world->SetTOIBudget(toi_budget);
+}
+
+void ModulePhysics::SetSubSteps(int _substeps)
+{
+	WaitStep();
+	substeps = MAX(_substeps, 1);
+}
+
+void ModulePhysics::SetAdaptiveIterations(bool enable)
+{
+	WaitStep();
+	adaptive_iterations = enable;
+}
+
+void ModulePhysics::SetParallelIslands(bool enable)
+{
+	WaitStep();
+	parallel_islands = enable;
+
+	if (world != NULL)
+		world->SetTaskExecutor(enable ? this : NULL);
+}
+
+void ModulePhysics::SetContactSolver(b2ContactSolverMode mode)
+{
+	WaitStep();
+	contact_solver = mode;
+
+	if (world != NULL)
+		world->SetContactSolver(mode);
+}
+
+int32 ModulePhysics::GetTaskCount() const
+{
+	// Threads waiting on the job system run tasks too
+	return App->jobs->GetWorkerCount() + 1;
+}
+
+void ModulePhysics::Run(int32 count, b2TaskFunction* task, void* context)
+{
+	App->jobs->ParallelFor(count, 1, [task, context](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			task(i, context);
+	});
+}
+
+void ModulePhysics::ResetBudgetStats()
+{
+	WaitStep();
+	budget_stats = {};
+}
+
+void ModulePhysics::ResetTunnelingStats()
+{
+	WaitStep();
+	tunneling_stats = {};
+}
+
+void ModulePhysics::SetTickHashing(bool enable)
+{
+	WaitStep();
+	tick_hashing = enable;
+	tick_hashes.clear();
+}
+
+void ModulePhysics::TakeTickHashes(std::vector<uint32>& hashes)
+{
+	// A pipelined frame's last tick may still be running and about to push its hash
+	WaitStep();
+	hashes.insert(hashes.end(), tick_hashes.begin(), tick_hashes.end());
+	tick_hashes.clear();
+}
+
+// FNV-1a over the raw bits, any difference at all changes the hash
+static uint32 HashBytes(uint32 hash, const void* data, size_t size)
+{
+	const uint8* bytes = (const uint8*)data;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+uint32 ModulePhysics::HashWorld() const
+{
+	uint32 hash = 2166136261u;
+
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		if (b->GetType() == b2_staticBody)
+			continue;
+
+		float values[6] = { b->GetTransform().p.x, b->GetTransform().p.y, b->GetAngle(),
+			b->GetLinearVelocity().x, b->GetLinearVelocity().y, b->GetAngularVelocity() };
+		hash = HashBytes(hash, values, sizeof(values));
+	}
+
+	return hash;
+}
+
+struct ContactEventState
+{
+	int body;
+	int other;
+	b2Vec2 normal;
+	float approach_speed;
+	ContactFixtureType fixture_type;
+};
+
+// Index of the body in the world body list, as of the last GatherStateBodies
+int ModulePhysics::StateBodyIndex(const PhysBody* pbody) const
+{
+	if (pbody == NULL)
+		return -1;
+
+	for (size_t i = 0; i < state_bodies.size(); ++i)
+	{
+		if (state_bodies[i] == pbody->body) return (int)i;
+	}
+	return -1;
+}
+
+PhysBody* ModulePhysics::StateBody(int index) const
+{
+	if (index < 0 || index >= (int)state_bodies.size())
+		return NULL;
+
+	return (PhysBody*)state_bodies[index]->GetUserData().pointer;
+}
+
+void ModulePhysics::GatherStateBodies()
+{
+	state_bodies.clear();
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+		state_bodies.push_back(b);
+}
+
+void ModulePhysics::SaveState(std::vector<uint8>& state)
+{
+	WaitStep();
+	GatherStateBodies();
+
+	PutState(state, tick_count);
+	PutState(state, accumulator);
+
+	int world_size = world->GetStateSize();
+	PutState(state, world_size);
+	size_t offset = state.size();
+	state.resize(offset + world_size);
+	world->SaveState(state.data() + offset);
+
+	PutState(state, (int)tracked_bodies.size());
+	for (const PhysBody* pbody : tracked_bodies)
+	{
+		PutState(state, pbody->previous_position);
+		PutState(state, pbody->previous_angle);
+	}
+
+	// The registries keep no order, but what iterates them does
+	for (int type = 0; type < CIRCLE_TYPE_COUNT; ++type)
+	{
+		PutState(state, (int)circles[type].size());
+		for (const PhysBody* pbody : circles[type])
+			PutState(state, StateBodyIndex(pbody));
+	}
+
+	PutState(state, (int)sensor_overlaps.size());
+	for (const SensorOverlap& overlap : sensor_overlaps)
+	{
+		int contact_index = 0;
+		for (const b2Contact* c = world->GetContactList(); c != overlap.contact; c = c->GetNext())
+			++contact_index;
+
+		PutState(state, contact_index);
+		PutState(state, StateBodyIndex(overlap.sensor));
+		PutState(state, StateBodyIndex(overlap.other));
+	}
+
+	// Contacts of the last frame's ticks wait for the next PreUpdate to reach the game
+	PutState(state, contact_event_count);
+	for (int i = 0; i < contact_event_count; ++i)
+	{
+		const ContactEvent& ev = contact_events[i];
+		ContactEventState event_state = { StateBodyIndex(ev.body), StateBodyIndex(ev.other), ev.normal, ev.approach_speed, ev.fixture_type };
+		PutState(state, event_state);
+	}
+}
+
+// Walks a state written by SaveState without applying any of it. Body indices are checked
+// against the last GatherStateBodies, b2World::LoadState keeps that same list or refuses
+bool ModulePhysics::CheckState(const uint8* in, const uint8* end) const
+{
+	uint64 saved_tick = 0;
+	double saved_accumulator = 0.0;
+	int world_size = 0;
+	if (GetState(in, end, saved_tick) == false || GetState(in, end, saved_accumulator) == false || GetState(in, end, world_size) == false
+		|| world_size < 0 || end - in < world_size)
+		return false;
+
+	int contact_count = b2World::GetStateContactCount(in, world_size);
+	in += world_size;
+
+	int count = 0;
+	if (GetState(in, end, count) == false || count != (int)tracked_bodies.size())
+		return false;
+
+	for (int i = 0; i < count; ++i)
+	{
+		b2Vec2 position;
+		float angle;
+		if (GetState(in, end, position) == false || GetState(in, end, angle) == false)
+			return false;
+	}
+
+	for (int type = 0; type < CIRCLE_TYPE_COUNT; ++type)
+	{
+		if (GetState(in, end, count) == false || count < 0)
+			return false;
+
+		for (int i = 0; i < count; ++i)
+		{
+			int index = -1;
+			if (GetState(in, end, index) == false || StateBody(index) == NULL)
+				return false;
+		}
+	}
+
+	if (GetState(in, end, count) == false || count < 0)
+		return false;
+
+	for (int i = 0; i < count; ++i)
+	{
+		int contact_index = -1, sensor = -1, other = -1;
+		if (GetState(in, end, contact_index) == false || GetState(in, end, sensor) == false || GetState(in, end, other) == false
+			|| contact_index < 0 || contact_index >= contact_count || StateBody(sensor) == NULL || StateBody(other) == NULL)
+			return false;
+	}
+
+	if (GetState(in, end, count) == false || count < 0 || count > PHYSICS_MAX_CONTACT_EVENTS)
+		return false;
+
+	// Dispatch calls the listener of the body, the other side can be a body without a PhysBody
+	for (int i = 0; i < count; ++i)
+	{
+		ContactEventState event_state;
+		if (GetState(in, end, event_state) == false)
+			return false;
+
+		PhysBody* pbody = StateBody(event_state.body);
+		if (pbody == NULL || pbody->listener == NULL || event_state.other < -1 || event_state.other >= (int)state_bodies.size())
+			return false;
+	}
+
+	return true;
+}
+
+bool ModulePhysics::LoadState(const uint8*& in, const uint8* end)
+{
+	WaitStep();
+
+	// Everything is checked before the world changes, a refused state leaves it as it was.
+	// The world state leaves mouse joints out, a debug drag carries on from the restored positions
+	GatherStateBodies();
+
+	uint64 saved_tick = 0;
+	double saved_accumulator = 0.0;
+	int world_size = 0;
+	if (CheckState(in, end) == false || GetState(in, end, saved_tick) == false || GetState(in, end, saved_accumulator) == false
+		|| GetState(in, end, world_size) == false || world->LoadState(in, world_size) == false)
+	{
+		LOG_ERROR("Physics state does not match this world");
+		return false;
+	}
+	in += world_size;
+
+	tick_count = scheduled_ticks = saved_tick;
+	accumulator = saved_accumulator;
+
+	// Past the world every read below was already checked by CheckState
+	int count = 0;
+	GetState(in, end, count);
+	for (PhysBody* pbody : tracked_bodies)
+	{
+		GetState(in, end, pbody->previous_position);
+		GetState(in, end, pbody->previous_angle);
+	}
+
+	for (int type = 0; type < CIRCLE_TYPE_COUNT; ++type)
+	{
+		for (PhysBody* pbody : circles[type])
+			pbody->circle_index = -1;
+		circles[type].clear();
+
+		GetState(in, end, count);
+		for (int i = 0; i < count; ++i)
+		{
+			int index = -1;
+			GetState(in, end, index);
+
+			PhysBody* pbody = StateBody(index);
+			pbody->circle_index = (int)circles[type].size();
+			circles[type].push_back(pbody);
+		}
+	}
+
+	// The world rebuilt its contacts in the saved order
+	sensor_overlaps.clear();
+	GetState(in, end, count);
+	for (int i = 0; i < count; ++i)
+	{
+		int contact_index = 0, sensor = -1, other = -1;
+		GetState(in, end, contact_index);
+		GetState(in, end, sensor);
+		GetState(in, end, other);
+
+		b2Contact* contact = world->GetContactList();
+		for (int k = 0; k < contact_index; ++k)
+			contact = contact->GetNext();
+
+		sensor_overlaps.push_back({ contact, StateBody(sensor), StateBody(other) });
+	}
+
+	GetState(in, end, contact_event_count);
+	for (int i = 0; i < contact_event_count; ++i)
+	{
+		ContactEventState event_state;
+		GetState(in, end, event_state);
+
+		contact_events[i] = { StateBody(event_state.body), StateBody(event_state.other), event_state.normal,
+			event_state.approach_speed, event_state.fixture_type };
+	}
+
+	return true;
+}
+
+void ModulePhysics::TrackBody(PhysBody* pbody)
+{
+	pbody->previous_position = pbody->body->GetPosition();
+	pbody->previous_angle = pbody->body->GetAngle();
+	pbody->draw_previous_position = pbody->draw_position = pbody->previous_position;
+	pbody->draw_previous_angle = pbody->draw_angle = pbody->previous_angle;
+	tracked_bodies.push_back(pbody);
+}
+
+void ModulePhysics::Snapshot()
+{
+	for (PhysBody* pbody : tracked_bodies)
+	{
+		pbody->draw_previous_position = pbody->previous_position;
+		pbody->draw_previous_angle = pbody->previous_angle;
+		pbody->draw_position = pbody->body->GetPosition();
+		pbody->draw_angle = pbody->body->GetAngle();
+	}
+}
+
+// No game code runs inside b2World::Step: contacts are only copied into the
+// event buffer and handed to the listeners once the step has returned
+void ModulePhysics::RecordContact(PhysBody* body, PhysBody* other, const b2Vec2& normal, float approach_speed, ContactFixtureType fixture_type)
+{
+	if (contact_event_count == PHYSICS_MAX_CONTACT_EVENTS)
+	{
+		++dropped_contact_events;
+		return;
+	}
+
+	ContactEvent& contact = contact_events[contact_event_count++];
+	contact.body = body;
+	contact.other = other;
+	contact.normal = normal;
+	contact.approach_speed = approach_speed;
+	contact.fixture_type = fixture_type;
+}
+
+void ModulePhysics::DispatchContacts()
+{
+	PROFILE_SCOPE("Contact Dispatch");
+
+	// Listeners never destroy bodies directly, so every pointer stays valid for the whole batch
+	for (int i = 0; i < contact_event_count; ++i)
+	{
+		const ContactEvent& contact = contact_events[i];
+		contact.body->listener->OnCollision(contact.body, contact.other);
+	}
+	contact_event_count = 0;
+
+	if (dropped_contact_events > 0)
+	{
+		LOG_WARNING("Contact event buffer full, %d contacts dropped", dropped_contact_events);
+		dropped_contact_events = 0;
+	}
+}
+
+void ModulePhysics::StartStep(int ticks)
+{
+	if (ticks <= 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(step_mutex);
+		step_ticks = ticks;
+	}
+	step_condition.notify_all();
+}
+
+void ModulePhysics::WaitStep()
+{
+	std::unique_lock<std::mutex> lock(step_mutex);
+	step_condition.wait(lock, [this] { return step_ticks == 0; });
+}
+
+void ModulePhysics::StepThread()
+{
+	std::unique_lock<std::mutex> lock(step_mutex);
+
+	while (true)
+	{
+		step_condition.wait(lock, [this] { return step_ticks > 0 || step_quit; });
+		if (step_quit)
+			break;
+
+		// The main thread leaves the world alone until step_ticks is back to 0
+		int ticks = step_ticks;
+		lock.unlock();
+
+		for (int i = 0; i < ticks; ++i)
+			Tick();
+
+		lock.lock();
+		step_ticks = 0;
+		step_condition.notify_all();
+	}
+}
+
+void ModulePhysics::DrawDebug() const
+{
+	if (debug)
+		debug_draw.Submit();
+}
+
+void ModulePhysics::DestroyBody(b2Body* body)
+{
+	for (auto it = tracked_bodies.begin(); it != tracked_bodies.end(); )
+	{
+		if ((*it)->body == body)
+			it = tracked_bodies.erase(it);
+		else
+			++it;
+	}
+
+	PhysBody* pbody = (PhysBody*)body->GetUserData().pointer;
+	if (pbody != NULL)
+		UnregisterCircle(pbody);
+
+	world->DestroyBody(body);
+}
+
+void ModulePhysics::SetBodyEnabled(PhysBody* pbody, bool enabled)
+{
+	if (pbody->body == NULL || pbody->body->IsEnabled() == enabled)
+		return;
+
+	pbody->body->SetEnabled(enabled);
+
+	if (enabled)
+		RegisterCircle(pbody);
+	else
+		UnregisterCircle(pbody);
+}
+
+// Dynamic pokeballs, the only bodies that may become bullets
+bool ModulePhysics::IsBall(const PhysBody* pbody) const
+{
+	const b2Fixture* fixture = pbody->body->GetFixtureList();
+	return pbody->body->GetType() == b2_dynamicBody && fixture != NULL
+		&& fixture->GetType() == b2Shape::e_circle && pbody->circleType == POKEBALL;
+}
+
+void ModulePhysics::RegisterCircle(PhysBody* pbody)
+{
+	if (pbody->body->GetFixtureList()->GetType() != b2Shape::e_circle || pbody->circle_index >= 0)
+		return;
+
+	std::vector<PhysBody*>& registry = circles[pbody->circleType];
+	pbody->circle_index = (int)registry.size();
+	registry.push_back(pbody);
+}
+
+// Swap with the last one, the registry does not keep an order
+void ModulePhysics::UnregisterCircle(PhysBody* pbody)
+{
+	if (pbody->circle_index < 0)
+		return;
+
+	std::vector<PhysBody*>& registry = circles[pbody->circleType];
+	PhysBody* last = registry.back();
+	registry[pbody->circle_index] = last;
+	last->circle_index = pbody->circle_index;
+	registry.pop_back();
+	pbody->circle_index = -1;
 }
 
 PhysBody* ModulePhysics::CreateCircle(int x, int y, int radius, BodyType bodyType, CircleType circleType)
@@ -92,6 +830,7 @@ PhysBody* ModulePhysics::CreateCircle(int x, int y, int radius, BodyType bodyTyp
 
 	body.position.Set(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
 	body.userData.pointer = reinterpret_cast<uintptr_t>(pbody);
+	body.bullet = ball_bullet && bodyType == DYNAMIC && circleType == POKEBALL;
 
 	b2Body* b = world->CreateBody(&body);
 
@@ -106,10 +845,12 @@ PhysBody* ModulePhysics::CreateCircle(int x, int y, int radius, BodyType bodyTyp
 
 	pbody->body = b;
 	pbody->width = pbody->height = radius;
+	TrackBody(pbody);
 
 	// Asigna el tipo de cuerpo al PhysBody
 	pbody->bodyType = bodyType;
 	pbody->circleType = circleType;
+	RegisterCircle(pbody);
 
 	return pbody;
 }
@@ -139,6 +880,7 @@ PhysBody* ModulePhysics::CreateRectangle(int x, int y, int width, int height)
 	pbody->body = b;
 	pbody->width = (int)(width * 0.5f);
 	pbody->height = (int)(height * 0.5f);
+	TrackBody(pbody);
 
 	return pbody;
 }
@@ -167,123 +909,184 @@ PhysBody* ModulePhysics::CreateRectangleSensor(int x, int y, int width, int heig
 	pbody->body = b;
 	pbody->width = width;
 	pbody->height = height;
+	TrackBody(pbody);
 
 
 	return pbody;
 }
 
-PhysBody* ModulePhysics::CreateChain(int x, int y, const int* points, int size)
+PhysBody* ModulePhysics::CreateChain(int x, int y, const b2Vec2* vertices, int count)
 {
 	PhysBody* pbody = new PhysBody();
 
+	// Walls never move: static bodies skip integration, sleep checks and islands
 	b2BodyDef body;
-	body.type = b2_dynamicBody;
+	body.type = bake_playfield ? b2_staticBody : b2_dynamicBody;
 	body.position.Set(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
 	body.userData.pointer = reinterpret_cast<uintptr_t>(pbody);
 
 	b2Body* b = world->CreateBody(&body);
-
-	b2ChainShape shape;
-	b2Vec2* p = new b2Vec2[size / 2];
-
-	for(int i = 0; i < size / 2; ++i)
-	{
-		p[i].x = PIXEL_TO_METERS(points[i * 2 + 0]);
-		p[i].y = PIXEL_TO_METERS(points[i * 2 + 1]);
-	}
-
-	shape.CreateLoop(p, size / 2);
-
-	b2FixtureDef fixture;
-	fixture.shape = &shape;
-
-	b->CreateFixture(&fixture);
-
-	delete p;
+	AddChainLoop(b, vertices, count);
 
 	pbody->body = b;
 	pbody->width = pbody->height = 0;
+	TrackBody(pbody);
 
 	return pbody;
 }
 
-PhysBody* ModulePhysics::CreateLeftFlipper(int x,int y)
+PhysBody* ModulePhysics::CreatePlayfieldChain(const b2Vec2* vertices, int count)
 {
+	if (bake_playfield == false)
+		return CreateChain(0, 0, vertices, count);
 
-	PhysBody* leftFlipper = new PhysBody();
+	// Created with the first wall, every wall after that is one more fixture
+	if (playfield == NULL)
+	{
+		playfield = new PhysBody();
 
+		b2BodyDef body;
+		body.type = b2_staticBody;
+		body.userData.pointer = reinterpret_cast<uintptr_t>(playfield);
 
-	b2Vec2 anchorLeft(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
+		playfield->body = world->CreateBody(&body);
+		playfield->width = playfield->height = 0;
+		TrackBody(playfield);
+	}
 
+	AddChainLoop(playfield->body, vertices, count);
 
-	b2BodyDef anchorDef;
-	anchorDef.type = b2_staticBody;
-	anchorDef.position = anchorLeft;
-	b2Body* leftAnchor = world->CreateBody(&anchorDef);
+	return playfield;
+}
 
+void ModulePhysics::AddChainLoop(b2Body* body, const b2Vec2* vertices, int count)
+{
+	// Outlines are in meters already, CreateLoop copies them into the shape
+	SimplifyChainLoop(vertices, count, PIXEL_TO_METERS(chain_tolerance), chain_scratch);
 
-	leftFlipper->body = CreateRectangle(METERS_TO_PIXELS(anchorLeft.x), METERS_TO_PIXELS(anchorLeft.y), 60, 10)->body;
+	b2ChainShape shape;
+	shape.CreateLoop(chain_scratch.data(), (int)chain_scratch.size());
 
+	// Kept in world space for the clearance check
+	const b2Vec2& origin = body->GetPosition();
+	ChainRecord record = { (int)traced_vertices.size(), count, (int)simplified_vertices.size(), (int)chain_scratch.size() };
+	chains.push_back(record);
+	for (int i = 0; i < count; ++i)
+		traced_vertices.push_back(origin + vertices[i]);
+	for (const b2Vec2& v : chain_scratch)
+		simplified_vertices.push_back(origin + v);
 
-	b2RevoluteJointDef jointDef;
-	jointDef.enableMotor = true;
-	jointDef.maxMotorTorque = 1000.0f;
-	jointDef.enableLimit = true;
-	jointDef.lowerAngle = -30.0f * b2_pi / 180.0f;
-	jointDef.upperAngle = 30.0f * b2_pi / 180.0f;
+	b2FixtureDef fixture;
+	fixture.shape = &shape;
 
-	jointDef.bodyA = leftAnchor;
-	jointDef.bodyB = leftFlipper->body;
-	jointDef.localAnchorA.SetZero();
-	jointDef.localAnchorB.Set(-PIXEL_TO_METERS(30), 0);
-	lJoint = (b2RevoluteJoint*)world->CreateJoint(&jointDef);
+	body->CreateFixture(&fixture);
+}
 
+PhysicsWorldStats ModulePhysics::GetWorldStats() const
+{
+	PhysicsWorldStats stats = {};
+	stats.bodies = world->GetBodyCount();
+	stats.proxies = world->GetProxyCount();
+	stats.joints = world->GetJointCount();
+	stats.contacts = world->GetContactCount();
+	stats.islands = world->GetIslandCount();
+
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		if (b->GetType() != b2_staticBody && b->IsAwake() && b->IsEnabled())
+			++stats.awake_bodies;
+	}
 
-	leftFlipper->width = 60;
-	leftFlipper->height = 10;
+	for (const b2Contact* c = world->GetContactList(); c; c = c->GetNext())
+	{
+		if (c->IsTouching())
+			++stats.touching_contacts;
+	}
 
-	return leftFlipper;
+	return stats;
 }
 
-PhysBody* ModulePhysics::CreateRightFlipper(int x, int y)
+PhysicsChainStats ModulePhysics::GetChainStats() const
 {
+	PhysicsChainStats stats = {};
+	stats.chains = (int)chains.size();
 
-	PhysBody* rightFlipper = new PhysBody();
+	for (const ChainRecord& chain : chains)
+	{
+		stats.edges_before += chain.traced_count;
+		stats.edges_after += chain.simplified_count;
+
+		float deviation = ChainLoopDeviation(&traced_vertices[chain.traced_first], chain.traced_count,
+			&simplified_vertices[chain.simplified_first], chain.simplified_count);
+		stats.max_deviation = MAX(stats.max_deviation, PIXELS_PER_METER * deviation);
+	}
 
+	return stats;
+}
 
-	b2Vec2 anchorRight(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
+int ModulePhysics::CheckChainClearance(float ball_radius)
+{
+	// A gap lets the ball through when it is wider than its diameter
+	float diameter = PIXEL_TO_METERS(ball_radius * 2.0f);
+	float largest_change = 0.0f;
+	int changed = 0;
+
+	for (size_t i = 0; i < chains.size(); ++i)
+	{
+		for (size_t j = i + 1; j < chains.size(); ++j)
+		{
+			const ChainRecord& a = chains[i];
+			const ChainRecord& b = chains[j];
 
-	b2BodyDef anchorDef;
-	anchorDef.type = b2_staticBody;
-	anchorDef.position = anchorRight;
-	b2Body* rightAnchor = world->CreateBody(&anchorDef);
+			float traced = ChainLoopDistance(&traced_vertices[a.traced_first], a.traced_count,
+				&traced_vertices[b.traced_first], b.traced_count);
+			float simplified = ChainLoopDistance(&simplified_vertices[a.simplified_first], a.simplified_count,
+				&simplified_vertices[b.simplified_first], b.simplified_count);
 
+			largest_change = MAX(largest_change, fabsf(simplified - traced));
 
-	rightFlipper->body = CreateRectangle(METERS_TO_PIXELS(anchorRight.x), METERS_TO_PIXELS(anchorRight.y), 60, 10)->body;
+			if ((traced > diameter) != (simplified > diameter))
+			{
+				LOG_WARNING("Chains %d and %d: gap goes from %.1f to %.1f pixels, the ball is %.1f wide",
+					(int)i, (int)j, PIXELS_PER_METER * traced, PIXELS_PER_METER * simplified, ball_radius * 2.0f);
+				++changed;
+			}
+		}
+	}
 
-	b2RevoluteJointDef jointDef;
-	jointDef.enableMotor = true;
-	jointDef.maxMotorTorque = 1000.0f;
-	jointDef.enableLimit = true;
+	LOG("Chain clearance: %d of %d gaps changed for the ball, largest change %.2f pixels",
+		changed, (int)(chains.size() * (chains.size() - 1) / 2), PIXELS_PER_METER * largest_change);
 
+	return changed;
+}
 
-	jointDef.lowerAngle = -30.0f * b2_pi / 180.0f;
-	jointDef.upperAngle = 30.0f * b2_pi / 180.0f;
+// Kinematic: FlipperController moves it, no anchor body and no joint for the solver.
+// No PhysBody in the user data, flipper contacts are not reported to the game
+PhysBody* ModulePhysics::CreateFlipper(int x, int y, int width, int height)
+{
+	PhysBody* pbody = new PhysBody();
 
-	jointDef.bodyA = rightAnchor;
-	jointDef.bodyB = rightFlipper->body;
-	jointDef.localAnchorA.SetZero();
+	b2BodyDef body;
+	body.type = b2_kinematicBody;
+	body.position.Set(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
 
+	b2Body* b = world->CreateBody(&body);
 
-	jointDef.localAnchorB.Set(PIXEL_TO_METERS(30), 0);
+	b2PolygonShape box;
+	box.SetAsBox(PIXEL_TO_METERS(width) * 0.5f, PIXEL_TO_METERS(height) * 0.5f);
 
-	rJoint = (b2RevoluteJoint*)world->CreateJoint(&jointDef);
+	b2FixtureDef fixture;
+	fixture.shape = &box;
+	fixture.density = 1.0f;
 
+	b->CreateFixture(&fixture);
 
-	rightFlipper->width = 60;
-	rightFlipper->height = 10;
+	pbody->body = b;
+	pbody->width = width;
+	pbody->height = height;
+	TrackBody(pbody);
 
-	return rightFlipper;
+	return pbody;
 }
 
 PhysBody* ModulePhysics::CreateSpringBase(int x, int y, int width, int height)
@@ -294,288 +1097,135 @@ PhysBody* ModulePhysics::CreateSpringBase(int x, int y, int width, int height)
 
 	PhysBody* springBase = new PhysBody();
 	springBase->body = world->CreateBody(&baseDef);
+	TrackBody(springBase);
 
 	return springBase;
 }
 // 
 update_status ModulePhysics::PostUpdate()
 {
-	if (IsKeyPressed(KEY_F1))
-	{
-		debug = !debug;
-	}
+	debug_draw.Clear();
 
-	if (!debug)
-	{
-		if (App->scene_intro->deleteCircles) //si es true
-		{
-			std::vector<b2Body*> bodiesToDestroy;
+	ApplyFrameChanges();
 
-			for (b2Body* b = world->GetBodyList(); b != nullptr; b = b->GetNext())
-			{
-				bool isCirclePOKEBALL = false;
-
-				for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
-				{
-					if (f->GetType() == b2Shape::e_circle)
-					{
-						// Verificamos si es del tipo POKEBALL
-						PhysBody* pbody = (PhysBody*)b->GetUserData().pointer;
-
-						if (pbody && pbody->circleType == POKEBALL)
-						{
-							isCirclePOKEBALL = true;
-						}
-						break; 
-					}
-				}
-
-				if (isCirclePOKEBALL)
-				{
-					bodiesToDestroy.push_back(b); 
-				}
-			}
-
-			for (b2Body* b : bodiesToDestroy)
-			{
-				world->DestroyBody(b);
-			}
+	// The world won't change again this frame: copy what rendering needs
+	// and let the physics thread step while the main thread draws
+	if (App->IsHeadless() == false)
+		Snapshot();
 
-			App->scene_intro->deleteCircles = false;
-		}
-		return UPDATE_CONTINUE;
+	if (pipelined)
+	{
+		StartStep(pending_ticks);
 	}
-
-	if (App->scene_intro->deleteCircles) // Si es true
+	else
 	{
-		if (mouse_joint != nullptr)
-		{
-			world->DestroyJoint(mouse_joint);
-			mouse_joint = nullptr;
-		}
-
-		std::vector<b2Body*> bodiesToDestroy;
-
-		for (b2Body* b = world->GetBodyList(); b != nullptr; b = b->GetNext())
-		{
-			bool isCirclePOKEBALL = false;
-
-			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
-			{
-				if (f->GetType() == b2Shape::e_circle)
-				{
-
-					PhysBody* pbody = (PhysBody*)b->GetUserData().pointer;
+		// Pipelining was switched off with ticks still owed
+		for (int i = 0; i < pending_ticks; ++i)
+			Tick();
+	}
+	pending_ticks = 0;
 
-					if (pbody && pbody->circleType == POKEBALL)
-					{
-						isCirclePOKEBALL = true;
-					}
-					break;
-				}
-			}
+	return UPDATE_CONTINUE;
+}
 
-			if (isCirclePOKEBALL)
-			{
-				bodiesToDestroy.push_back(b);
-			}
-		}
+// First dynamic fixture containing the point. Parked balls are not in the broad-phase
+class MousePickCallback : public b2QueryCallback
+{
+public:
+	MousePickCallback(const b2Vec2& point) : point(point), body(nullptr)
+	{}
 
-		for (b2Body* b : bodiesToDestroy)
+	bool ReportFixture(b2Fixture* fixture) override
+	{
+		if (fixture->GetBody()->GetType() == b2_dynamicBody && fixture->TestPoint(point))
 		{
-			world->DestroyBody(b);
+			body = fixture->GetBody();
+			return false;
 		}
-
-		App->scene_intro->deleteCircles = false;
+		return true;
 	}
 
-	if (IsKeyPressed(KEY_TWO))
-	{
-
-		std::vector<b2Body*> bodiesToDestroy;
-
-		for (b2Body* b = world->GetBodyList(); b != nullptr; b = b->GetNext())
-		{
-			bool isCirclePOKEBALL = false; 
-
-			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
-			{
-				if (f->GetType() == b2Shape::e_circle)
-				{
-
-					PhysBody* pbody = (PhysBody*)b->GetUserData().pointer;
+	b2Vec2 point;
+	b2Body* body;
+};
 
-					if (pbody && pbody->circleType == POKEBALL)
-					{
-						isCirclePOKEBALL = true;
-					}
-					break;
-				}
-			}
-
-			if (isCirclePOKEBALL)
-			{
-				bodiesToDestroy.push_back(b);
-			}
-		}
+// Input driven changes to the world: debug view and mouse joint
+void ModulePhysics::ApplyFrameChanges()
+{
+	const FrameInput& input = App->input->GetFrameInput();
 
-		for (b2Body* b : bodiesToDestroy)
-		{
-			world->DestroyBody(b);
-		}
+	if (input.IsPressed(BUTTON_DEBUG))
+	{
+		debug = !debug;
 	}
 
+	// Extra overlays on top of the debug view
+	if (input.IsPressed(BUTTON_DEBUG_AABBS)) debug_overlays ^= b2Draw::e_aabbBit;
+	if (input.IsPressed(BUTTON_DEBUG_JOINTS)) debug_overlays ^= b2Draw::e_jointBit;
+	if (input.IsPressed(BUTTON_DEBUG_CONTACTS)) debug_overlays ^= PhysicsDebugDraw::e_contactBit;
+	if (input.IsPressed(BUTTON_DEBUG_CENTERS)) debug_overlays ^= b2Draw::e_centerOfMassBit;
 
+	// Drained balls were already parked by ModuleGame, Update has seen the drain by now
+	App->scene_intro->deleteCircles = false;
 
-	// Bonus code: this will iterate all objects in the world and draw the circles
-	// You need to provide your own macro to translate meters to pixels
-	for(b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	if (!debug)
 	{
-		for(b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
-		{
-			switch(f->GetType())
-			{
-				// Draw circles ------------------------------------------------
-				case b2Shape::e_circle:
-				{
-					b2CircleShape* shape = (b2CircleShape*)f->GetShape();
-					b2Vec2 pos = f->GetBody()->GetPosition();
-					
-					DrawCircle(METERS_TO_PIXELS(pos.x), METERS_TO_PIXELS(pos.y), (float)METERS_TO_PIXELS(shape->m_radius), Color{0, 0, 0, 10});
-				}
-				break;
-
-				// Draw polygons ------------------------------------------------
-				case b2Shape::e_polygon:
-				{
-					b2PolygonShape* polygonShape = (b2PolygonShape*)f->GetShape();
-					int32 count = polygonShape->m_count;
-					b2Vec2 prev, v;
-
-					for(int32 i = 0; i < count; ++i)
-					{
-						v = b->GetWorldPoint(polygonShape->m_vertices[i]);
-						if(i > 0)
-							DrawLine(METERS_TO_PIXELS(prev.x), METERS_TO_PIXELS(prev.y), METERS_TO_PIXELS(v.x), METERS_TO_PIXELS(v.y), RED);
-
-						prev = v;
-					}
-
-					v = b->GetWorldPoint(polygonShape->m_vertices[0]);
-					DrawLine(METERS_TO_PIXELS(prev.x), METERS_TO_PIXELS(prev.y), METERS_TO_PIXELS(v.x), METERS_TO_PIXELS(v.y), RED);
-				}
-				break;
-
-				// Draw chains contour -------------------------------------------
-				case b2Shape::e_chain:
-				{
-					b2ChainShape* shape = (b2ChainShape*)f->GetShape();
-					b2Vec2 prev, v;
-
-					for(int32 i = 0; i < shape->m_count; ++i)
-					{
-						v = b->GetWorldPoint(shape->m_vertices[i]);
-						if(i > 0)
-							DrawLine(METERS_TO_PIXELS(prev.x), METERS_TO_PIXELS(prev.y), METERS_TO_PIXELS(v.x), METERS_TO_PIXELS(v.y), GREEN);
-						prev = v;
-					}
-
-					v = b->GetWorldPoint(shape->m_vertices[0]);
-					DrawLine(METERS_TO_PIXELS(prev.x), METERS_TO_PIXELS(prev.y), METERS_TO_PIXELS(v.x), METERS_TO_PIXELS(v.y), GREEN);
-				}
-				break;
-
-				// Draw a single segment(edge) ----------------------------------
-				case b2Shape::e_edge:
-				{
-					b2EdgeShape* shape = (b2EdgeShape*)f->GetShape();
-					b2Vec2 v1, v2;
-
-					v1 = b->GetWorldPoint(shape->m_vertex0);
-					v1 = b->GetWorldPoint(shape->m_vertex1);
-					DrawLine(METERS_TO_PIXELS(v1.x), METERS_TO_PIXELS(v1.y), METERS_TO_PIXELS(v2.x), METERS_TO_PIXELS(v2.y), BLUE);
-				}
-				break;
-			}
-			b2Body* mouseSelect = nullptr;
-			Vector2 mousePosition = GetMousePosition();
-			b2Vec2 pMousePosition = b2Vec2(PIXEL_TO_METERS(mousePosition.x), PIXEL_TO_METERS(mousePosition.y));
-			b2Vec2 pos = b->GetPosition();
-
-			float angle = b->GetAngle() * 180.0f / b2_pi;
+		return;
+	}
 
-			Vector2 texturePosition = { (float)(METERS_TO_PIXELS(pos.x) - 30), (float)(METERS_TO_PIXELS(pos.y) - 5) };
+	// Let go of a ball that was parked while being dragged
+	if (mouse_joint != nullptr && mouse_joint->GetBodyB()->IsEnabled() == false)
+	{
+		world->DestroyJoint(mouse_joint);
+		mouse_joint = nullptr;
+	}
 
-			if (mouse_joint == nullptr && mouseSelect == nullptr && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+	debug_draw.Record(world, debug_overlays);
 
-				if (f->TestPoint(pMousePosition)) {
-					mouseSelect = b;
-				
-				}
-			}
-			if (mouseSelect) {
-				b2MouseJointDef def;
+	// Mouse joint: drag the dynamic body under the cursor
+	b2Vec2 pMousePosition = b2Vec2(PIXEL_TO_METERS(input.mouse_x), PIXEL_TO_METERS(input.mouse_y));
 
-				def.bodyA = ground;
-				def.bodyB = mouseSelect;
-				def.target = pMousePosition;
-				def.damping = 0.5f;
-				def.stiffness = 20.f;
-				def.maxForce = 100.f * mouseSelect->GetMass();
+	if (mouse_joint == nullptr && input.IsPressed(BUTTON_MOUSE_LEFT)) {
 
-				mouse_joint = (b2MouseJoint*)world->CreateJoint(&def);
-			}
+		// The broad-phase narrows it down to the few fixtures around the cursor
+		MousePickCallback pick(pMousePosition);
+		b2AABB aabb;
+		aabb.lowerBound = pMousePosition - b2Vec2(0.001f, 0.001f);
+		aabb.upperBound = pMousePosition + b2Vec2(0.001f, 0.001f);
+		world->QueryAABB(&pick, aabb);
 
-			// TODO 3: If the player keeps pressing the mouse button, update
-			// target position and draw a red line between both anchor points
-			else if (mouse_joint && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-				mouse_joint->SetTarget(pMousePosition);
-				b2Vec2 anchorPosition = mouse_joint->GetBodyB()->GetPosition();
-				anchorPosition.x = METERS_TO_PIXELS(anchorPosition.x);
-				anchorPosition.y = METERS_TO_PIXELS(anchorPosition.y);
+		if (pick.body != nullptr) {
+			b2MouseJointDef def;
 
-				DrawLine(anchorPosition.x, anchorPosition.y, mousePosition.x, mousePosition.y, RED);
-			}
+			def.bodyA = ground;
+			def.bodyB = pick.body;
+			def.target = pMousePosition;
+			def.damping = 0.5f;
+			def.stiffness = 20.f;
+			def.maxForce = 100.f * pick.body->GetMass();
 
-			// TODO 4: If the player releases the mouse button, destroy the joint
-			else if (mouse_joint && IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-				world->DestroyJoint(mouse_joint);
-				mouse_joint = nullptr;
-			}
+			mouse_joint = (b2MouseJoint*)world->CreateJoint(&def);
 		}
-
 	}
 
+	// TODO 3: If the player keeps pressing the mouse button, update
+	// target position and draw a red line between both anchor points
+	else if (mouse_joint && input.IsDown(BUTTON_MOUSE_LEFT)) {
+		mouse_joint->SetTarget(pMousePosition);
+		debug_draw.DrawSegment(mouse_joint->GetBodyB()->GetPosition(), pMousePosition, b2Color(1.0f, 0.0f, 0.0f));
+	}
 
-	
-
-	return UPDATE_CONTINUE;
+	// TODO 4: If the player releases the mouse button, destroy the joint
+	else if (mouse_joint && input.IsReleased(BUTTON_MOUSE_LEFT)) {
+		world->DestroyJoint(mouse_joint);
+		mouse_joint = nullptr;
+	}
 }
 
 			
 			
 			
 
-void ModulePhysics::DrawFlipper(Texture2D flipperTexture, PhysBody* flipper, b2RevoluteJoint* joint)
-{
-	// Obtiene el ngulo de la pala en radianes y lo convierte a grados
-	float angleDegrees = RADTODEG * joint->GetJointAngle();
-
-	// Obtiene la posicin de la pala en pixeles
-	b2Vec2 position = flipper->body->GetPosition();
-	int posX = METERS_TO_PIXELS(position.x);
-	int posY = METERS_TO_PIXELS(position.y);
-
-	// Dibuja la textura en la posicin y rotacin actual de la pala
-	DrawTexturePro(
-		flipperTexture,
-		Rectangle{ 0, 0, (float)flipperTexture.width, (float)flipperTexture.height },
-		Rectangle{ (float)posX, (float)posY, (float)flipperTexture.width, (float)flipperTexture.height },
-		Vector2{ (float)(flipperTexture.width / 2), (float)(flipperTexture.height / 2) }, // Centro de rotacin de la textura
-		angleDegrees,
-		WHITE
-	);
-}
 void ModulePhysics::DrawSpring()
 {
 	if (springPiston != nullptr)
@@ -592,11 +1242,31 @@ void ModulePhysics::DrawSpring()
 bool ModulePhysics::CleanUp()
 {
 	LOG("Destroying physics world");
+
+	// Listeners are already cleaned up, drop whatever the last step reported
+	WaitStep();
+	contact_event_count = 0;
+
+	if (step_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(step_mutex);
+			step_quit = true;
+		}
+		step_condition.notify_all();
+		step_thread.join();
+	}
+
 	UnloadTexture(leftFlipperTexture);
 	UnloadTexture(rightFlipperTexture);
 	UnloadTexture(muelle);
 	// Delete the whole physics world!
 	delete world;
+	// No EndContact when the world goes away
+	sensor_overlaps.clear();
+	chains.clear();
+	traced_vertices.clear();
+	simplified_vertices.clear();
 
 	return true;
 }
@@ -613,6 +1283,43 @@ float PhysBody::GetRotation() const
 	return body->GetAngle();
 }
 
+void PhysBody::GetDrawPosition(int& x, int& y) const
+{
+	x = METERS_TO_PIXELS(draw_position.x);
+	y = METERS_TO_PIXELS(draw_position.y);
+}
+
+float PhysBody::GetDrawRotation() const
+{
+	return draw_angle;
+}
+
+void PhysBody::GetInterpolatedPosition(int& x, int& y, float alpha) const
+{
+	b2Vec2 pos = draw_previous_position + alpha * (draw_position - draw_previous_position);
+	x = METERS_TO_PIXELS(pos.x);
+	y = METERS_TO_PIXELS(pos.y);
+}
+
+float PhysBody::GetInterpolatedRotation(float alpha) const
+{
+	return draw_previous_angle + alpha * (draw_angle - draw_previous_angle);
+}
+
+// Moves the body without a trace: no velocity left and nothing to interpolate from
+void PhysBody::Teleport(int x, int y)
+{
+	if (body) {
+		b2Vec2 position(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
+		body->SetTransform(position, 0.0f);
+		body->SetLinearVelocity(b2Vec2_zero);
+		body->SetAngularVelocity(0.0f);
+
+		previous_position = draw_previous_position = draw_position = position;
+		previous_angle = draw_previous_angle = draw_angle = 0.0f;
+	}
+}
+
 void PhysBody::Rotate(float angle)
 {
 	if (body) {
@@ -674,15 +1381,72 @@ int PhysBody::RayCast(int x1, int y1, int x2, int y2, float& normal_x, float& no
 
 void ModulePhysics::BeginContact(b2Contact* contact)
 {
-	b2BodyUserData dataA = contact->GetFixtureA()->GetBody()->GetUserData();
-	b2BodyUserData dataB = contact->GetFixtureB()->GetBody()->GetUserData();
+	b2Fixture* fixtureA = contact->GetFixtureA();
+	b2Fixture* fixtureB = contact->GetFixtureB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	PhysBody* physA = (PhysBody*)bodyA->GetUserData().pointer;
+	PhysBody* physB = (PhysBody*)bodyB->GetUserData().pointer;
+
+	bool notifyA = (physA && physA->listener != NULL);
+	bool notifyB = (physB && physB->listener != NULL);
+	if (notifyA == false && notifyB == false)
+		return;
+
+	// Sensors have no manifold, fall back to the line between the body centers
+	ContactFixtureType fixture_type = (fixtureA->IsSensor() || fixtureB->IsSensor()) ? CONTACT_SENSOR : CONTACT_SOLID;
+	b2Vec2 normal;
+	b2Vec2 point;
+
+	if (contact->GetManifold()->pointCount > 0)
+	{
+		b2WorldManifold world_manifold;
+		contact->GetWorldManifold(&world_manifold);
+		normal = world_manifold.normal;
+		point = world_manifold.points[0];
+	}
+	else
+	{
+		normal = bodyB->GetWorldCenter() - bodyA->GetWorldCenter();
+		normal.Normalize();
+		point = bodyA->GetWorldCenter();
+	}
 
-	PhysBody* physA = (PhysBody*)dataA.pointer;
-	PhysBody* physB = (PhysBody*)dataB.pointer;
+	b2Vec2 relative_velocity = bodyA->GetLinearVelocityFromWorldPoint(point) - bodyB->GetLinearVelocityFromWorldPoint(point);
+	float approach_speed = b2Dot(relative_velocity, normal);
 
-	if(physA && physA->listener != NULL)
-		physA->listener->OnCollision(physA, physB);
+	if(notifyA)
+		RecordContact(physA, physB, normal, approach_speed, fixture_type);
 
-	if(physB && physB->listener != NULL)
-		physB->listener->OnCollision(physB, physA);
+	if(notifyB)
+		RecordContact(physB, physA, -normal, approach_speed, fixture_type);
+
+	if (physA && physB)
+	{
+		if (notifyA && fixtureA->IsSensor())
+			sensor_overlaps.push_back({ contact, physA, physB });
+		if (notifyB && fixtureB->IsSensor())
+			sensor_overlaps.push_back({ contact, physB, physA });
+	}
+}
+
+// Also called for touching contacts of bodies being destroyed, so no overlap outlives its bodies
+void ModulePhysics::EndContact(b2Contact* contact)
+{
+	if (contact->GetFixtureA()->IsSensor() == false && contact->GetFixtureB()->IsSensor() == false)
+		return;
+
+	for (size_t i = 0; i < sensor_overlaps.size(); )
+	{
+		if (sensor_overlaps[i].contact == contact)
+		{
+			sensor_overlaps[i] = sensor_overlaps.back();
+			sensor_overlaps.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
 }
\ No newline at end of file
@@ -3,8 +3,16 @@
 #include "Module.h"
 #include "Globals.h"
 #include "ModuleGame.h"
+#include "PhysicsDebugDraw.h"
+#include "Timer.h"
 
-#include "box2d\box2d.h"
+#include "box2d/box2d.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #define GRAVITY_X 0.0f
 #define GRAVITY_Y -7.0f
@@ -12,20 +20,76 @@
 #define PIXELS_PER_METER 50.0f // if touched change METER_PER_PIXEL too
 #define METER_PER_PIXEL 0.02f // this is 1 / PIXELS_PER_METER !
 
+// Adaptive iteration range, the budget climbs from the minimum to the maximum
+// as the fastest ball nears ADAPTIVE_FAST_BALL_SPEED or the touching contacts
+// of awake bodies near ADAPTIVE_BUSY_CONTACTS, whichever is higher
+#define ADAPTIVE_MIN_VELOCITY_ITERATIONS 2
+#define ADAPTIVE_MAX_VELOCITY_ITERATIONS 10
+#define ADAPTIVE_MIN_POSITION_ITERATIONS 1
+#define ADAPTIVE_MAX_POSITION_ITERATIONS 4
+#define ADAPTIVE_FAST_BALL_SPEED 15.0f	// m/s
+#define ADAPTIVE_BUSY_CONTACTS 8
+
 #define METERS_TO_PIXELS(m) ((int) floor(PIXELS_PER_METER * m))
 #define PIXEL_TO_METERS(p)  ((float) METER_PER_PIXEL * p)
 
+// Collision outline already converted to meters, built at compile time from a pixel array
+template<int N>
+struct ChainOutline
+{
+	static_assert(N >= 3, "A chain loop needs at least 3 points");
+
+	b2Vec2 vertices[N];
+	static constexpr int count = N;
+};
+
+template<int SIZE, size_t... I>
+constexpr ChainOutline<SIZE / 2> ConvertOutline(const int (&points)[SIZE], std::index_sequence<I...>)
+{
+	return ChainOutline<SIZE / 2>{ { b2Vec2(PIXEL_TO_METERS(points[I * 2 + 0]), PIXEL_TO_METERS(points[I * 2 + 1]))... } };
+}
+
+// Two consecutive points on the same pixel would trip b2ChainShape::CreateLoop
+template<int SIZE>
+constexpr bool HasRepeatedPoint(const int (&points)[SIZE])
+{
+	for (int i = 0; i < SIZE; i += 2)
+	{
+		int next = (i + 2) % SIZE;
+		if (points[i] == points[next] && points[i + 1] == points[next + 1]) return true;
+	}
+	return false;
+}
+
+// Use it to initialize a constexpr variable, a bad outline then fails to compile
+template<int SIZE>
+constexpr ChainOutline<SIZE / 2> PixelOutline(const int (&points)[SIZE])
+{
+	static_assert(SIZE % 2 == 0, "Outline pixel arrays are x, y pairs");
+
+	return HasRepeatedPoint(points)
+		? throw "Outline has two consecutive points on the same pixel"
+		: ConvertOutline(points, std::make_index_sequence<SIZE / 2>());
+}
+
 // Small class to return to other modules to track position and rotation of physics bodies
 class PhysBody
 {
 public:
-	PhysBody() : listener(NULL), body(NULL)
+	PhysBody() : listener(NULL), body(NULL), entity(NULL), circle_index(-1)
 	{}
 
 	//void GetPosition(int& x, int& y) const;
 	void GetPhysicPosition(int& x, int &y) const;
 	float GetRotation() const;
+	// Rendering only reads the snapshot taken by ModulePhysics, never the b2Body
+	void GetDrawPosition(int& x, int& y) const;
+	float GetDrawRotation() const;
+	// Blend between the last two physics ticks, alpha comes from ModulePhysics::GetInterpolationAlpha()
+	void GetInterpolatedPosition(int& x, int& y, float alpha) const;
+	float GetInterpolatedRotation(float alpha) const;
 	void Rotate(float angle);
+	void Teleport(int x, int y);
 	bool Contains(int x, int y) const;
 	int RayCast(int x1, int y1, int x2, int y2, float& normal_x, float& normal_y) const;
 
@@ -34,13 +98,101 @@ public:
 	int width, height;
 	b2Body* body;
 	Module* listener;
+	PhysicEntity* entity;	// Game object owning this body, if any
 	BodyType bodyType;
 	CircleType circleType;
+	int circle_index;		// Slot in the circle registry of ModulePhysics, -1 when not in it
+
+	// Transform before the last physics tick, used for render interpolation
+	b2Vec2 previous_position;
+	float previous_angle;
+
+	// Snapshot for rendering, copied while the physics thread is idle
+	b2Vec2 draw_previous_position;
+	b2Vec2 draw_position;
+	float draw_previous_angle;
+	float draw_angle;
+};
+
+enum ContactFixtureType
+{
+	CONTACT_SOLID,
+	CONTACT_SENSOR
+};
+
+// A contact seen during the step, dispatched to body->listener once the step is over
+struct ContactEvent
+{
+	PhysBody* body;
+	PhysBody* other;
+	b2Vec2 normal;			// From body towards other
+	float approach_speed;	// Closing speed along the normal in m/s, negative when separating
+	ContactFixtureType fixture_type;
+};
+
+// A sensor fixture currently overlapping another body, kept from BeginContact to EndContact
+struct SensorOverlap
+{
+	b2Contact* contact;
+	PhysBody* sensor;
+	PhysBody* other;
+};
+
+struct PhysicsWorldStats
+{
+	int bodies;
+	int awake_bodies;		// Non static bodies the solver still processes
+	int proxies;			// Broad-phase proxies, one per chain edge
+	int joints;
+	int contacts;
+	int touching_contacts;
+	int islands;			// Solved by the last world step
+};
+
+// Continuous collision counters, summed over the ticks since the last reset
+// (TOI counters are per world step, there are GetSubSteps() of them per tick)
+struct PhysicsTunnelingStats
+{
+	uint64 ticks;
+	uint64 toi_events;			// Contacts found to impact during a tick
+	uint64 toi_substeps;		// TOI events solved, one island sub-step each
+	uint64 budget_ticks;		// World steps that ran out of TOI budget with impacts left
+	uint64 held_bodies;			// Bodies stopped at such an impact instead of swept past it
+	int max_substeps;			// Most TOI sub-steps in a single world step
+	uint64 wall_penetrations;	// Ball centers that went through the solid side of a wall
+};
+
+// Solver work chosen for one tick
+struct PhysicsStepBudget
+{
+	int substeps;
+	int velocity_iterations;	// Per world step
+	int position_iterations;
+	float max_ball_speed;		// m/s, fastest ball in play when the tick started
+	int active_contacts;		// Touching contacts with an awake body
+};
 
+// Budget totals over the ticks since the last reset, iterations summed over every world step
+struct PhysicsBudgetStats
+{
+	uint64 ticks;
+	uint64 substeps;
+	uint64 velocity_iterations;
+	uint64 position_iterations;
+	uint64 top_budget_ticks;	// Ticks that got ADAPTIVE_MAX_VELOCITY_ITERATIONS
+	PhysicsStepBudget last;
+};
+
+struct PhysicsChainStats
+{
+	int chains;
+	int edges_before;		// Edges of the traced outlines, one per vertex in a loop
+	int edges_after;		// Edges left once simplified, the ones that became fixtures
+	float max_deviation;	// Pixels, farthest a traced vertex lies from its simplified loop
 };
 
 // Module --------------------------------------
-class ModulePhysics : public Module, public b2ContactListener
+class ModulePhysics : public Module, public b2ContactListener, public b2TaskExecutor
 {
 public:
 	ModulePhysics(Application* app, bool start_enabled = true);
@@ -51,33 +203,135 @@ public:
 	update_status PostUpdate();
 	bool CleanUp();
 
+	// Shapes recorded by PostUpdate while the world was idle, drawn over the scene
+	void DrawDebug() const;
+
 	PhysBody* CreateCircle(int x, int y, int radius, BodyType bodyType, CircleType circleType);
 	PhysBody* CreateRectangle(int x, int y, int width, int height);
 	PhysBody* CreateRectangleSensor(int x, int y, int width, int height);
-	PhysBody* CreateChain(int x, int y, const int* points, int size);
-	PhysBody* CreateLeftFlipper(int x, int y);
-	PhysBody* CreateRightFlipper(int x, int y);
-	void DrawFlipper(Texture2D flipperTexture, PhysBody* flipper, b2RevoluteJoint* joint);
+	PhysBody* CreateChain(int x, int y, const b2Vec2* vertices, int count);
+	template<int N>
+	PhysBody* CreateChain(int x, int y, const ChainOutline<N>& outline) { return CreateChain(x, y, outline.vertices, N); }
+	// Walls with no game logic of their own: baked into one static body shared by all of them.
+	// Its entity is the last wall created, only the collision type tells them apart anyway
+	PhysBody* CreatePlayfieldChain(const b2Vec2* vertices, int count);
+	template<int N>
+	PhysBody* CreatePlayfieldChain(const ChainOutline<N>& outline) { return CreatePlayfieldChain(outline.vertices, N); }
+	// Kinematic box for a FlipperController to drive
+	PhysBody* CreateFlipper(int x, int y, int width, int height);
 	void DrawSpring();
-	PhysBody* ModulePhysics::CreateSpringBase(int x, int y, int width, int height);
+	PhysBody* CreateSpringBase(int x, int y, int width, int height);
 	b2World* GetWorld() { return world; };
 
+	// Enabled circle bodies of each CircleType, dense and unordered
+	const std::vector<PhysBody*>& GetCircles(CircleType type) const { return circles[type]; }
+	// Disabled bodies stay allocated but leave the broad-phase, so they neither move nor collide
+	void SetBodyEnabled(PhysBody* pbody, bool enabled);
+
+	// Off builds every wall as its own dynamic body like before baking, set it before Start
+	void SetPlayfieldBaking(bool enable) { bake_playfield = enable; }
+	bool IsPlayfieldBaking() const { return bake_playfield; }
+	PhysicsWorldStats GetWorldStats() const;
+
+	// Douglas-Peucker tolerance for chain outlines in pixels, 0 keeps every vertex. Set it before Start
+	void SetChainTolerance(float pixels) { chain_tolerance = pixels; }
+	float GetChainTolerance() const { return chain_tolerance; }
+	PhysicsChainStats GetChainStats() const;
+	// Compares the gaps between every two chains before and after simplification.
+	// Returns how many of them changed between letting a ball of ball_radius pixels through or not
+	int CheckChainClearance(float ball_radius);
+
+	// Bullets also sweep against dynamic bodies (flippers, plunger), only balls are ever bullets
+	void SetBallBullet(bool enable);
+	bool IsBallBullet() const { return ball_bullet; }
+	// TOI sub-steps per world step, 0 = no limit. Balls left over stop at their impact,
+	// which can still tunnel: wall_penetrations in GetTunnelingStats must stay 0
+	void SetTOIBudget(int substeps);
+	int GetTOIBudget() const { return toi_budget; }
+	// Read while the world is idle, like GetWorldStats
+	const PhysicsTunnelingStats& GetTunnelingStats() const { return tunneling_stats; }
+	void ResetTunnelingStats();
+
+	// Each tick runs substeps world steps of tick_dt / substeps
+	void SetSubSteps(int substeps);
+	int GetSubSteps() const { return substeps; }
+	// Off: every world step gets PHYSICS_VELOCITY_ITERATIONS and PHYSICS_POSITION_ITERATIONS
+	void SetAdaptiveIterations(bool enable);
+	bool IsAdaptiveIterations() const { return adaptive_iterations; }
+	const PhysicsBudgetStats& GetBudgetStats() const { return budget_stats; }
+	void ResetBudgetStats();
+
+	void SetTickRate(int ticks_per_second);
+	int GetTickRate() const { return tick_rate; }
+	float GetInterpolationAlpha() const { return interpolation_alpha; }
+	// First tick that is neither stepped nor handed to the physics thread yet
+	uint64 GetNextTick() const { return scheduled_ticks; }
+
+	// Replays dictate how many ticks the next frame steps instead of the clock
+	void SetNextFrameTicks(int ticks) { forced_frame_ticks = ticks; }
+	// Hash of every body transform and velocity after each tick, collected by TakeTickHashes
+	void SetTickHashing(bool enable);
+	void TakeTickHashes(std::vector<uint32>& hashes);
+	uint32 HashWorld() const;
+	// Everything the next tick depends on: tick counters, the b2World state with its
+	// contacts and broad-phase, the ball registry and sensor overlaps and the contacts
+	// still waiting to reach the game. Restoring into the same world is bit-exact.
+	// Only between frames. A debug mouse drag is not part of it and is left alone
+	void SaveState(std::vector<uint8>& state);
+	bool LoadState(const uint8*& in, const uint8* end);
+
+	// Pipelined: the ticks of a frame run on the physics thread while the main thread renders
+	void SetPipelined(bool enable);
+	bool IsPipelined() const { return pipelined; }
+
+	// Islands of a world step spread over the job system, one task per thread.
+	// Every island is still solved on its own, so the outcome is the same bit for bit
+	void SetParallelIslands(bool enable);
+	bool IsParallelIslands() const { return parallel_islands; }
+
+	// Wide solves the contacts of an island in colored batches of b2GetWideContactLanes() with SIMD,
+	// plain the same batches without it. Both give the same result, just not the default one
+	void SetContactSolver(b2ContactSolverMode mode);
+	b2ContactSolverMode GetContactSolver() const { return contact_solver; }
 
 	
 
 	PhysBody* springPiston;
 	// b2ContactListener ---
 	void BeginContact(b2Contact* contact);
+	void EndContact(b2Contact* contact);
+
+	// b2TaskExecutor ---
+	int32 GetTaskCount() const;
+	void Run(int32 count, b2TaskFunction* task, void* context);
 
 private:
-	
+	void Tick();
+	void TrackBody(PhysBody* pbody);
+	void DestroyBody(b2Body* body);
+	bool IsBall(const PhysBody* pbody) const;
+	PhysicsStepBudget ChooseStepBudget() const;
+	void AddTOIStats();
+	void CheckTunneling();
+	void AddChainLoop(b2Body* body, const b2Vec2* vertices, int count);
+	void RegisterCircle(PhysBody* pbody);
+	void UnregisterCircle(PhysBody* pbody);
+	void ApplyFrameChanges();
+	void Snapshot();
+	void RecordContact(PhysBody* body, PhysBody* other, const b2Vec2& normal, float approach_speed, ContactFixtureType fixture_type);
+	void DispatchContacts();
+	void GatherStateBodies();
+	bool CheckState(const uint8* in, const uint8* end) const;
+	int StateBodyIndex(const PhysBody* pbody) const;
+	PhysBody* StateBody(int index) const;
+
+	void StartStep(int ticks);
+	void WaitStep();
+	void StepThread();
+
 	bool debug;
 	b2World* world;
 	b2MouseJoint* mouse_joint;
-	b2Body* rFlipper;
-	b2Body* lFlipper;
-	b2RevoluteJoint* rJoint;
-	b2RevoluteJoint* lJoint;
 	b2Body* ground;
 	Texture2D leftFlipperTexture;
 	Texture2D rightFlipperTexture;
@@ -85,5 +339,68 @@ private:
 	PhysBody* leftFlipper;
 	PhysBody* rightFlipper;
 	b2Body* springBase;
+	bool bake_playfield;
+	PhysBody* playfield;
+
+	// Every chain loop created, traced and simplified, in world meters. Only read by the load time checks
+	struct ChainRecord
+	{
+		int traced_first;
+		int traced_count;
+		int simplified_first;
+		int simplified_count;
+	};
+	float chain_tolerance;
+	std::vector<ChainRecord> chains;
+	std::vector<b2Vec2> traced_vertices;
+	std::vector<b2Vec2> simplified_vertices;
+	std::vector<b2Vec2> chain_scratch;
+
+	// Continuous collision
+	bool ball_bullet;
+	int toi_budget;
+	PhysicsTunnelingStats tunneling_stats;
+
+	// Sub-stepping
+	int substeps;
+	bool adaptive_iterations;
+	PhysicsBudgetStats budget_stats;
+	bool parallel_islands;
+	b2ContactSolverMode contact_solver;
 	b2PrismaticJoint* springJoint;
+
+	// Fixed timestep
+	int tick_rate;
+	double tick_dt;
+	double accumulator;
+	float interpolation_alpha;
+	uint64 tick_count;			// Ticks stepped, owned by whoever is stepping
+	uint64 scheduled_ticks;		// Ticks stepped or pending, main thread only
+	Timer frame_timer;
+	int forced_frame_ticks;		// -1 when the clock decides
+	bool tick_hashing;
+	std::vector<uint32> tick_hashes;
+	std::vector<b2Body*> state_bodies;	// World body list order, for the indices in saved states
+	std::vector<PhysBody*> tracked_bodies;
+	std::vector<PhysBody*> circles[CIRCLE_TYPE_COUNT];
+
+	// Pipelining
+	bool pipelined;
+	int pending_ticks;
+	std::thread step_thread;
+	std::mutex step_mutex;
+	std::condition_variable step_condition;
+	int step_ticks;		// Ticks left for the physics thread, guarded by step_mutex
+	bool step_quit;
+
+	// Contacts of the ticks since the last dispatch, written by whoever is stepping
+	ContactEvent contact_events[PHYSICS_MAX_CONTACT_EVENTS];
+	int contact_event_count;
+	int dropped_contact_events;
+
+	// Unordered, removal swaps with the last one
+	std::vector<SensorOverlap> sensor_overlaps;
+
+	PhysicsDebugDraw debug_draw;
+	uint32 debug_overlays;		// b2Draw flags toggled with F3-F6
 };
\ No newline at end of file
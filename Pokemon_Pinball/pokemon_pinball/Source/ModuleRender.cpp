@@ -1,8 +1,10 @@
 #include "Globals.h"
 #include "Application.h"
+#include "AssetLoader.h"
 #include "ModuleWindow.h"
 #include "ModuleRender.h"
 #include "ModuleFonts.h"
+#include "ModulePhysics.h"
 #include <math.h>
 
 ModuleRender::ModuleRender(Application* app, bool start_enabled) : Module(app, start_enabled)
@@ -19,7 +21,7 @@ bool ModuleRender::Init()
 {
 	LOG("Creating Renderer context");
 	bool ret = true;
-    background = LoadTexture("Assets/mapa.png");
+    App->assets->RequestTexture("Assets/mapa.png", &background);
 	return ret;
 }
 
@@ -48,6 +50,7 @@ update_status ModuleRender::PostUpdate()
 {
     int FPS = GetFPS();
     // Draw everything in our batch!
+    App->physics->DrawDebug();
     
     App->fontsModule->DrawText(550, 116, TextFormat("%d",FPS), WHITE);
 
@@ -0,0 +1,132 @@
+// ----------------------------------------------------
+// NullBackend.cpp
+// Headless replacement for the raylib functions the game uses.
+// Only linked in the headless build, never together with raylib.
+// ----------------------------------------------------
+
+#include "Globals.h"
+#include "NullBackend.h"
+
+#include "rlgl.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#define MAX_NULL_KEYS 512
+#define MAX_NULL_MOUSE_BUTTONS 8
+
+static double current_time = 0.0;
+static float last_frame_time = 0.0f;
+
+static bool keys[MAX_NULL_KEYS] = {};
+static bool previous_keys[MAX_NULL_KEYS] = {};
+static bool mouse_buttons[MAX_NULL_MOUSE_BUTTONS] = {};
+static bool previous_mouse_buttons[MAX_NULL_MOUSE_BUTTONS] = {};
+static Vector2 mouse_position = { 0.0f, 0.0f };
+
+void NullBackendNewFrame(double frame_time)
+{
+	current_time += frame_time;
+	last_frame_time = (float)frame_time;
+
+	memcpy(previous_keys, keys, sizeof(keys));
+	memcpy(previous_mouse_buttons, mouse_buttons, sizeof(mouse_buttons));
+}
+
+void NullBackendSetKey(int key, bool down)
+{
+	if (key >= 0 && key < MAX_NULL_KEYS) keys[key] = down;
+}
+
+void NullBackendSetMouseButton(int button, bool down)
+{
+	if (button >= 0 && button < MAX_NULL_MOUSE_BUTTONS) mouse_buttons[button] = down;
+}
+
+void NullBackendSetMousePosition(int x, int y)
+{
+	mouse_position = { (float)x, (float)y };
+}
+
+// Window and timing -------------------------------------------
+void InitWindow(int width, int height, const char* title) {}
+void CloseWindow(void) {}
+bool WindowShouldClose(void) { return false; }
+bool IsWindowMinimized(void) { return false; }
+bool IsWindowResized(void) { return false; }
+void SetWindowTitle(const char* title) {}
+void SetConfigFlags(unsigned int flags) {}
+void SetTargetFPS(int fps) {}
+int GetScreenWidth(void) { return SCREEN_WIDTH; }
+int GetScreenHeight(void) { return SCREEN_HEIGHT; }
+int GetFPS(void) { return (last_frame_time > 0.0f) ? (int)(1.0f / last_frame_time) : 0; }
+float GetFrameTime(void) { return last_frame_time; }
+double GetTime(void) { return current_time; }
+
+// Input -------------------------------------------------------
+bool IsKeyDown(int key) { return (key >= 0 && key < MAX_NULL_KEYS) ? keys[key] : false; }
+bool IsKeyUp(int key) { return !IsKeyDown(key); }
+bool IsKeyPressed(int key) { return IsKeyDown(key) && !previous_keys[key]; }
+bool IsKeyReleased(int key) { return (key >= 0 && key < MAX_NULL_KEYS) ? (!keys[key] && previous_keys[key]) : false; }
+
+bool IsMouseButtonDown(int button) { return (button >= 0 && button < MAX_NULL_MOUSE_BUTTONS) ? mouse_buttons[button] : false; }
+bool IsMouseButtonPressed(int button) { return IsMouseButtonDown(button) && !previous_mouse_buttons[button]; }
+bool IsMouseButtonReleased(int button) { return (button >= 0 && button < MAX_NULL_MOUSE_BUTTONS) ? (!mouse_buttons[button] && previous_mouse_buttons[button]) : false; }
+Vector2 GetMousePosition(void) { return mouse_position; }
+int GetMouseX(void) { return (int)mouse_position.x; }
+int GetMouseY(void) { return (int)mouse_position.y; }
+
+// Drawing -----------------------------------------------------
+void BeginDrawing(void) {}
+void EndDrawing(void) {}
+void ClearBackground(Color color) {}
+void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY, Color color) {}
+void DrawCircle(int centerX, int centerY, float radius, Color color) {}
+void DrawText(const char* text, int posX, int posY, int fontSize, Color color) {}
+void DrawTextEx(Font font, const char* text, Vector2 position, float fontSize, float spacing, Color tint) {}
+void DrawTexture(Texture2D texture, int posX, int posY, Color tint) {}
+void DrawTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint) {}
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint) {}
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {}
+
+void rlBegin(int mode) {}
+void rlEnd(void) {}
+void rlVertex2f(float x, float y) {}
+void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {}
+
+const char* TextFormat(const char* text, ...)
+{
+	static char buffer[1024];
+
+	va_list args;
+	va_start(args, text);
+	vsnprintf(buffer, sizeof(buffer), text, args);
+	va_end(args);
+
+	return buffer;
+}
+
+// Resources ---------------------------------------------------
+Texture2D LoadTexture(const char* fileName) { return Texture2D{ 1 }; }	// Non zero id: loaded as far as the game can tell
+void UnloadTexture(Texture2D texture) {}
+
+static unsigned char null_pixel[4] = {};
+Image LoadImage(const char* fileName) { return Image{ null_pixel, 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 }; }
+void UnloadImage(Image image) {}
+Texture2D LoadTextureFromImage(Image image) { return Texture2D{ 1 }; }
+
+// Audio -------------------------------------------------------
+void InitAudioDevice(void) {}
+void CloseAudioDevice(void) {}
+Sound LoadSound(const char* fileName) { return Sound{ 0 }; }
+Sound LoadSoundFromWave(Wave wave) { return Sound{ 0 }; }
+void UnloadSound(Sound sound) {}
+Wave LoadWave(const char* fileName) { return Wave{ 0 }; }
+void UnloadWave(Wave wave) {}
+void PlaySound(Sound sound) {}
+Music LoadMusicStream(const char* fileName) { return Music{ 0 }; }
+void UnloadMusicStream(Music music) {}
+bool IsMusicReady(Music music) { return false; }
+void PlayMusicStream(Music music) {}
+void StopMusicStream(Music music) {}
+void UpdateMusicStream(Music music) {}
@@ -0,0 +1,14 @@
+#pragma once
+
+// ----------------------------------------------------
+// Null raylib backend used by the headless build.
+// Window, drawing and audio calls do nothing, time advances
+// by a fixed step per frame and input is fed by a script.
+// ----------------------------------------------------
+
+// Advance the simulated clock and latch last frame's input (for IsKeyPressed/Released)
+void NullBackendNewFrame(double frame_time);
+
+void NullBackendSetKey(int key, bool down);
+void NullBackendSetMouseButton(int button, bool down);
+void NullBackendSetMousePosition(int x, int y);
@@ -0,0 +1,257 @@
+// ----------------------------------------------------
+// PhysicsDebugDraw.cpp
+// Recorded, batched Box2D debug view
+// ----------------------------------------------------
+
+#include "PhysicsDebugDraw.h"
+#include "ModulePhysics.h"
+
+#include "rlgl.h"
+
+#define DEBUG_CIRCLE_SEGMENTS 16
+
+// Same colors the per-shape DrawLine version used
+static const b2Color circle_color(0.0f, 0.0f, 0.0f, 10.0f / 255.0f);
+static const b2Color polygon_color(230.0f / 255.0f, 41.0f / 255.0f, 55.0f / 255.0f);		// RED
+static const b2Color chain_color(0.0f, 228.0f / 255.0f, 48.0f / 255.0f);					// GREEN
+static const b2Color edge_color(0.0f, 121.0f / 255.0f, 241.0f / 255.0f);					// BLUE
+static const b2Color contact_color(1.0f, 161.0f / 255.0f, 0.0f);							// ORANGE
+
+PhysicsDebugDraw::PhysicsDebugDraw() : line_target(&lines), triangle_target(&triangles), static_body_count(-1)
+{}
+
+void PhysicsDebugDraw::Clear()
+{
+	lines.clear();
+	triangles.clear();
+}
+
+void PhysicsDebugDraw::Record(b2World* world, uint32 overlays)
+{
+	// Static geometry only changes when bodies come and go
+	if (world->GetBodyCount() != static_body_count)
+	{
+		static_lines.clear();
+		static_triangles.clear();
+		line_target = &static_lines;
+		triangle_target = &static_triangles;
+
+		for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+		{
+			if (b->GetType() != b2_staticBody || b->IsEnabled() == false)
+				continue;
+
+			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+				DrawFixture(f, b->GetTransform());
+		}
+
+		line_target = &lines;
+		triangle_target = &triangles;
+		static_body_count = world->GetBodyCount();
+	}
+
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		// Parked pool balls are not on the table
+		if (b->GetType() == b2_staticBody || b->IsEnabled() == false)
+			continue;
+
+		for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+			DrawFixture(f, b->GetTransform());
+	}
+
+	if (overlays & e_contactBit)
+	{
+		for (b2Contact* c = world->GetContactList(); c; c = c->GetNext())
+		{
+			if (c->IsTouching() == false)
+				continue;
+
+			b2WorldManifold world_manifold;
+			c->GetWorldManifold(&world_manifold);
+
+			for (int32 i = 0; i < c->GetManifold()->pointCount; ++i)
+			{
+				const b2Vec2& p = world_manifold.points[i];
+				DrawPoint(p, 4.0f, contact_color);
+				DrawSegment(p, p + 0.3f * world_manifold.normal, contact_color);
+			}
+		}
+	}
+
+	// Joints, AABBs and centers of mass come from Box2D itself, shapes are done above
+	uint32 world_flags = overlays & (e_jointBit | e_aabbBit | e_pairBit | e_centerOfMassBit);
+	if (world_flags != 0)
+	{
+		SetFlags(world_flags);
+		world->DebugDraw();
+	}
+}
+
+void PhysicsDebugDraw::DrawFixture(b2Fixture* fixture, const b2Transform& xf)
+{
+	switch (fixture->GetType())
+	{
+		case b2Shape::e_circle:
+		{
+			b2CircleShape* shape = (b2CircleShape*)fixture->GetShape();
+			DrawSolidCircle(b2Mul(xf, shape->m_p), shape->m_radius, xf.q.GetXAxis(), circle_color);
+		}
+		break;
+
+		case b2Shape::e_polygon:
+		{
+			b2PolygonShape* shape = (b2PolygonShape*)fixture->GetShape();
+			b2Vec2 vertices[b2_maxPolygonVertices];
+
+			for (int32 i = 0; i < shape->m_count; ++i)
+				vertices[i] = b2Mul(xf, shape->m_vertices[i]);
+
+			DrawPolygon(vertices, shape->m_count, polygon_color);
+		}
+		break;
+
+		case b2Shape::e_chain:
+		{
+			// Loops repeat the first vertex at the end, no closing segment needed
+			b2ChainShape* shape = (b2ChainShape*)fixture->GetShape();
+			b2Vec2 prev = b2Mul(xf, shape->m_vertices[0]);
+
+			for (int32 i = 1; i < shape->m_count; ++i)
+			{
+				b2Vec2 v = b2Mul(xf, shape->m_vertices[i]);
+				DrawSegment(prev, v, chain_color);
+				prev = v;
+			}
+		}
+		break;
+
+		case b2Shape::e_edge:
+		{
+			b2EdgeShape* shape = (b2EdgeShape*)fixture->GetShape();
+			DrawSegment(b2Mul(xf, shape->m_vertex1), b2Mul(xf, shape->m_vertex2), edge_color);
+		}
+		break;
+
+		default:
+		break;
+	}
+}
+
+void PhysicsDebugDraw::AddVertex(std::vector<DebugVertex>& buffer, const b2Vec2& p, const b2Color& color)
+{
+	DebugVertex v;
+	v.x = PIXELS_PER_METER * p.x;
+	v.y = PIXELS_PER_METER * p.y;
+	v.r = (unsigned char)(color.r * 255.0f);
+	v.g = (unsigned char)(color.g * 255.0f);
+	v.b = (unsigned char)(color.b * 255.0f);
+	v.a = (unsigned char)(color.a * 255.0f);
+	buffer.push_back(v);
+}
+
+void PhysicsDebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+{
+	b2Vec2 prev = vertices[vertexCount - 1];
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		DrawSegment(prev, vertices[i], color);
+		prev = vertices[i];
+	}
+}
+
+void PhysicsDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+{
+	b2Color fill(color.r, color.g, color.b, color.a * 0.5f);
+
+	// Box2D winds counter-clockwise with y up, the screen has y down: reverse for rlgl
+	for (int32 i = 1; i < vertexCount - 1; ++i)
+	{
+		AddVertex(*triangle_target, vertices[0], fill);
+		AddVertex(*triangle_target, vertices[i + 1], fill);
+		AddVertex(*triangle_target, vertices[i], fill);
+	}
+
+	DrawPolygon(vertices, vertexCount, color);
+}
+
+void PhysicsDebugDraw::DrawCircle(const b2Vec2& center, float radius, const b2Color& color)
+{
+	const float step = 2.0f * b2_pi / DEBUG_CIRCLE_SEGMENTS;
+	b2Vec2 prev = center + b2Vec2(radius, 0.0f);
+
+	for (int i = 1; i <= DEBUG_CIRCLE_SEGMENTS; ++i)
+	{
+		b2Vec2 v = center + radius * b2Vec2(cosf(i * step), sinf(i * step));
+		DrawSegment(prev, v, color);
+		prev = v;
+	}
+}
+
+void PhysicsDebugDraw::DrawSolidCircle(const b2Vec2& center, float radius, const b2Vec2& axis, const b2Color& color)
+{
+	const float step = 2.0f * b2_pi / DEBUG_CIRCLE_SEGMENTS;
+	b2Vec2 prev = center + b2Vec2(radius, 0.0f);
+
+	for (int i = 1; i <= DEBUG_CIRCLE_SEGMENTS; ++i)
+	{
+		b2Vec2 v = center + radius * b2Vec2(cosf(i * step), sinf(i * step));
+		AddVertex(*triangle_target, center, color);
+		AddVertex(*triangle_target, v, color);
+		AddVertex(*triangle_target, prev, color);
+		prev = v;
+	}
+
+	DrawSegment(center, center + radius * axis, color);
+}
+
+void PhysicsDebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color)
+{
+	AddVertex(*line_target, p1, color);
+	AddVertex(*line_target, p2, color);
+}
+
+void PhysicsDebugDraw::DrawTransform(const b2Transform& xf)
+{
+	const float axis_scale = 0.4f;
+	DrawSegment(xf.p, xf.p + axis_scale * xf.q.GetXAxis(), b2Color(1.0f, 0.0f, 0.0f));
+	DrawSegment(xf.p, xf.p + axis_scale * xf.q.GetYAxis(), b2Color(0.0f, 1.0f, 0.0f));
+}
+
+void PhysicsDebugDraw::DrawPoint(const b2Vec2& p, float size, const b2Color& color)
+{
+	// size is in pixels
+	float half = 0.5f * size * METER_PER_PIXEL;
+	DrawSegment(p + b2Vec2(-half, -half), p + b2Vec2(half, half), color);
+	DrawSegment(p + b2Vec2(-half, half), p + b2Vec2(half, -half), color);
+}
+
+void PhysicsDebugDraw::Submit() const
+{
+	rlBegin(RL_TRIANGLES);
+	for (const DebugVertex& v : static_triangles)
+	{
+		rlColor4ub(v.r, v.g, v.b, v.a);
+		rlVertex2f(v.x, v.y);
+	}
+	for (const DebugVertex& v : triangles)
+	{
+		rlColor4ub(v.r, v.g, v.b, v.a);
+		rlVertex2f(v.x, v.y);
+	}
+	rlEnd();
+
+	// rlgl splits the batch by itself if it runs out of room
+	rlBegin(RL_LINES);
+	for (const DebugVertex& v : static_lines)
+	{
+		rlColor4ub(v.r, v.g, v.b, v.a);
+		rlVertex2f(v.x, v.y);
+	}
+	for (const DebugVertex& v : lines)
+	{
+		rlColor4ub(v.r, v.g, v.b, v.a);
+		rlVertex2f(v.x, v.y);
+	}
+	rlEnd();
+}
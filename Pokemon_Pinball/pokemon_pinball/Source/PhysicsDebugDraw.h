@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Globals.h"
+
+#include "box2d/box2d.h"
+
+#include <vector>
+
+// b2Draw that only records: shapes are converted to pixel space vertices while
+// the world is idle and submitted later as one batch of lines and one of triangles.
+// Static bodies never move, their outlines are transformed once and cached.
+class PhysicsDebugDraw : public b2Draw
+{
+public:
+
+	// Our own overlay, next to the b2Draw flags
+	enum
+	{
+		e_contactBit = 0x0100
+	};
+
+	PhysicsDebugDraw();
+
+	// Shapes of every enabled body plus the overlays in flags (b2Draw bits and e_contactBit)
+	void Record(b2World* world, uint32 overlays);
+	void Clear();
+
+	// Main thread, between BeginDrawing and EndDrawing
+	void Submit() const;
+
+	// b2Draw, coordinates in meters
+	void DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override;
+	void DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override;
+	void DrawCircle(const b2Vec2& center, float radius, const b2Color& color) override;
+	void DrawSolidCircle(const b2Vec2& center, float radius, const b2Vec2& axis, const b2Color& color) override;
+	void DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color) override;
+	void DrawTransform(const b2Transform& xf) override;
+	void DrawPoint(const b2Vec2& p, float size, const b2Color& color) override;
+
+private:
+
+	struct DebugVertex
+	{
+		float x, y;		// Pixels
+		unsigned char r, g, b, a;
+	};
+
+	void DrawFixture(b2Fixture* fixture, const b2Transform& xf);
+	void AddVertex(std::vector<DebugVertex>& buffer, const b2Vec2& p, const b2Color& color);
+
+	std::vector<DebugVertex> lines;			// Vertex pairs
+	std::vector<DebugVertex> triangles;
+	std::vector<DebugVertex> static_lines;	// Static bodies, kept between records
+	std::vector<DebugVertex> static_triangles;
+	std::vector<DebugVertex>* line_target;	// Where the b2Draw calls append, static or per record
+	std::vector<DebugVertex>* triangle_target;
+	int32 static_body_count;				// World body count when static_lines was built, -1 to rebuild
+};
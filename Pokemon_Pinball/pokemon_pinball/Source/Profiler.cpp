@@ -0,0 +1,78 @@
+// ----------------------------------------------------
+// Profiler.cpp
+// Lock-free zone recording and Chrome trace export
+// ----------------------------------------------------
+
+#include "Profiler.h"
+
+#include <chrono>
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<uint64> Profiler::write_index(0);
+ProfileEvent Profiler::events[PROFILER_MAX_EVENTS];
+
+static const std::chrono::steady_clock::time_point profiler_epoch = std::chrono::steady_clock::now();
+static std::atomic<uint32> next_thread_id(1);
+
+void Profiler::SetEnabled(bool enable)
+{
+	// Every session starts with an empty ring
+	if (enable == true && IsEnabled() == false)
+		write_index.store(0, std::memory_order_relaxed);
+
+	enabled.store(enable, std::memory_order_release);
+}
+
+uint64 Profiler::Now()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profiler_epoch).count();
+}
+
+uint32 Profiler::ThreadId()
+{
+	static thread_local uint32 thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+	return thread_id;
+}
+
+void Profiler::Record(const char* name, const char* category, uint64 start, uint64 end)
+{
+	// Each writer claims its own slot, no locks between threads
+	uint64 index = write_index.fetch_add(1, std::memory_order_relaxed);
+	ProfileEvent& ev = events[index & (PROFILER_MAX_EVENTS - 1)];
+
+	ev.name = name;
+	ev.category = category;
+	ev.start = start;
+	ev.end = end;
+	ev.thread_id = ThreadId();
+}
+
+bool Profiler::ExportChromeTrace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR("Cannot write profiler trace %s", path);
+		return false;
+	}
+
+	uint64 count = write_index.load(std::memory_order_acquire);
+	uint64 first = (count > PROFILER_MAX_EVENTS) ? count - PROFILER_MAX_EVENTS : 0;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (uint64 i = first; i < count; ++i)
+	{
+		const ProfileEvent& ev = events[i & (PROFILER_MAX_EVENTS - 1)];
+		fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			(i == first) ? "" : ",\n", ev.name, ev.category, ev.thread_id,
+			ev.start / 1000.0, (ev.end - ev.start) / 1000.0);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	LOG("Profiler trace with %llu events written to %s", (unsigned long long)(count - first), path);
+
+	return true;
+}
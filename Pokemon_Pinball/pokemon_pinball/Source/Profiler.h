@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+
+// Must be a power of two, older events are overwritten when the ring wraps
+#define PROFILER_MAX_EVENTS 65536
+#define PROFILER_TRACE_FILE "profile_trace.json"
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Time the enclosing scope as a named zone, only a flag check when the profiler is off
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_SCOPE_CATEGORY(name, category) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name, category)
+
+struct ProfileEvent
+{
+	const char* name;		// Must be a string literal or outlive the session
+	const char* category;
+	uint64 start;			// Nanoseconds since profiler startup
+	uint64 end;
+	uint32 thread_id;
+};
+
+// Frame profiler: zones from any thread go to a lock-free ring buffer and can be
+// exported as Chrome/Perfetto trace JSON (chrome://tracing, ui.perfetto.dev)
+class Profiler
+{
+public:
+
+	static void SetEnabled(bool enable);
+	static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static uint64 Now();
+	static void Record(const char* name, const char* category, uint64 start, uint64 end);
+
+	// Writes the events recorded since the profiler was last enabled
+	static bool ExportChromeTrace(const char* path);
+
+private:
+
+	static uint32 ThreadId();
+
+	static std::atomic<bool> enabled;
+	static std::atomic<uint64> write_index;
+	static ProfileEvent events[PROFILER_MAX_EVENTS];
+};
+
+class ProfileScope
+{
+public:
+
+	ProfileScope(const char* name, const char* category = "zone") : name(name), category(category)
+	{
+		active = Profiler::IsEnabled();
+		if (active) start = Profiler::Now();
+	}
+
+	~ProfileScope()
+	{
+		if (active) Profiler::Record(name, category, start, Profiler::Now());
+	}
+
+private:
+
+	const char* name;
+	const char* category;
+	uint64 start;
+	bool active;
+};
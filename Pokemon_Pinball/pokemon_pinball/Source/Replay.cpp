@@ -0,0 +1,380 @@
+// ----------------------------------------------------
+// Replay.cpp
+// Compact input recordings with per tick state hashes
+// ----------------------------------------------------
+
+#include "Replay.h"
+
+#include "box2d/box2d.h"
+
+#define TAG_TICKS_MASK	0x07
+#define TAG_CONTROLS	0x08
+#define TAG_BUTTONS		0x10
+#define TAG_MOUSE		0x20
+#define TAG_RUN			0x40
+
+static void PutVarint(std::vector<uint8>& out, uint64 value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((uint8)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8)value);
+}
+
+static bool GetVarint(const uint8*& in, const uint8* end, uint64& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && in < end; shift += 7)
+	{
+		uint8 byte = *in++;
+		value |= (uint64)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+static uint64 ZigZag(int64_t value)
+{
+	return ((uint64)value << 1) ^ (uint64)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64 value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint8 PackControls(const TickInput& controls)
+{
+	return (controls.left_flipper ? 1 : 0) | (controls.right_flipper ? 2 : 0) | (controls.plunger ? 4 : 0);
+}
+
+static TickInput UnpackControls(uint8 bits)
+{
+	return { (bits & 1) != 0, (bits & 2) != 0, (bits & 4) != 0 };
+}
+
+static void PutFrame(std::vector<uint8>& out, const ReplayFrame& frame)
+{
+	PutVarint(out, frame.ticks);
+	out.push_back(PackControls(frame.controls));
+	PutVarint(out, frame.buttons);
+	PutVarint(out, ZigZag(frame.mouse_x));
+	PutVarint(out, ZigZag(frame.mouse_y));
+}
+
+static bool GetFrame(const uint8*& in, const uint8* end, ReplayFrame& frame)
+{
+	uint64 ticks, buttons, x, y;
+	if (GetVarint(in, end, ticks) == false || in == end) return false;
+	frame.ticks = (int)ticks;
+	frame.controls = UnpackControls(*in++);
+	if (GetVarint(in, end, buttons) == false || GetVarint(in, end, x) == false || GetVarint(in, end, y) == false) return false;
+	frame.buttons = (uint32)buttons;
+	frame.mouse_x = (int)UnZigZag(x);
+	frame.mouse_y = (int)UnZigZag(y);
+	return true;
+}
+
+static const ReplayFrame empty_frame = { 0, { false, false, false }, 0, 0, 0 };
+
+// ReplayWriter -------------------------------
+
+ReplayWriter::ReplayWriter() : settings(), previous(empty_frame), frame_count(0), tick_count(0), run_length(0), run_ticks(0)
+{}
+
+void ReplayWriter::Begin(const ReplaySettings& _settings)
+{
+	settings = _settings;
+	frames.clear();
+	hashes.clear();
+	keyframes.clear();
+	previous = empty_frame;
+	frame_count = 0;
+	tick_count = 0;
+	run_length = 0;
+	run_ticks = 0;
+}
+
+void ReplayWriter::FlushRun()
+{
+	if (run_length == 0)
+		return;
+
+	uint8 tag = (uint8)MIN(run_ticks, TAG_TICKS_MASK);
+	if (run_length > 1) tag |= TAG_RUN;
+
+	frames.push_back(tag);
+	if (run_ticks >= TAG_TICKS_MASK) PutVarint(frames, run_ticks - TAG_TICKS_MASK);
+	if (run_length > 1) PutVarint(frames, run_length);
+
+	run_length = 0;
+}
+
+void ReplayWriter::AddFrame(const ReplayFrame& frame)
+{
+	uint8 tag = 0;
+	if ((frame.controls == previous.controls) == false) tag |= TAG_CONTROLS;
+	if (frame.buttons != previous.buttons) tag |= TAG_BUTTONS;
+	if (frame.mouse_x != previous.mouse_x || frame.mouse_y != previous.mouse_y) tag |= TAG_MOUSE;
+
+	++frame_count;
+	tick_count += frame.ticks;
+
+	// Most frames step one tick and change nothing, they only extend the run
+	if (tag == 0 && (run_length == 0 || frame.ticks == run_ticks))
+	{
+		run_ticks = frame.ticks;
+		++run_length;
+		return;
+	}
+
+	FlushRun();
+
+	if (tag == 0)
+	{
+		run_ticks = frame.ticks;
+		run_length = 1;
+		return;
+	}
+
+	tag |= (uint8)MIN(frame.ticks, TAG_TICKS_MASK);
+	frames.push_back(tag);
+	if (frame.ticks >= TAG_TICKS_MASK) PutVarint(frames, frame.ticks - TAG_TICKS_MASK);
+	if (tag & TAG_CONTROLS) frames.push_back(PackControls(frame.controls));
+	if (tag & TAG_BUTTONS) PutVarint(frames, frame.buttons);
+	if (tag & TAG_MOUSE)
+	{
+		PutVarint(frames, ZigZag((int64_t)frame.mouse_x - previous.mouse_x));
+		PutVarint(frames, ZigZag((int64_t)frame.mouse_y - previous.mouse_y));
+	}
+
+	previous = frame;
+}
+
+void ReplayWriter::AddKeyframe(std::vector<uint8>& state)
+{
+	// A pending run has to end here for the offset to point at a frame boundary
+	FlushRun();
+
+	ReplayKeyframe keyframe;
+	keyframe.frame = frame_count;
+	keyframe.tick = tick_count;
+	keyframe.offset = frames.size();
+	keyframe.previous = previous;
+	keyframe.state.swap(state);
+	keyframes.push_back(std::move(keyframe));
+}
+
+bool ReplayWriter::Save(const char* path)
+{
+	FlushRun();
+
+	std::vector<uint8> out;
+	PutState(out, (uint32)REPLAY_MAGIC);
+	PutVarint(out, REPLAY_VERSION);
+
+	PutVarint(out, settings.tick_rate);
+	PutVarint(out, settings.substeps);
+	out.push_back(settings.adaptive_iterations ? 1 : 0);
+	out.push_back(settings.ball_bullet ? 1 : 0);
+	PutVarint(out, settings.toi_budget);
+	out.push_back(settings.bake_playfield ? 1 : 0);
+	PutState(out, settings.chain_tolerance);
+	PutVarint(out, settings.contact_solver);
+
+	PutVarint(out, frame_count);
+	PutVarint(out, frames.size());
+	out.insert(out.end(), frames.begin(), frames.end());
+
+	PutVarint(out, hashes.size());
+	for (uint32 hash : hashes)
+		PutState(out, hash);
+
+	PutVarint(out, keyframes.size());
+	for (const ReplayKeyframe& keyframe : keyframes)
+	{
+		PutVarint(out, keyframe.frame);
+		PutVarint(out, keyframe.tick);
+		PutVarint(out, keyframe.offset);
+		PutFrame(out, keyframe.previous);
+		PutVarint(out, keyframe.state.size());
+		out.insert(out.end(), keyframe.state.begin(), keyframe.state.end());
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		LOG_ERROR("Cannot write replay %s", path);
+		return false;
+	}
+
+	bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+	fclose(file);
+
+	LOG("Replay %s: %llu frames, %llu ticks, %d bytes of input, %d keyframes", path, (unsigned long long)frame_count,
+		(unsigned long long)tick_count, (int)frames.size(), (int)keyframes.size());
+
+	return ok;
+}
+
+// ReplayReader -------------------------------
+
+ReplayReader::ReplayReader() : settings(), frame_count(0), offset(0), frame(0), previous(empty_frame), run_left(0)
+{}
+
+bool ReplayReader::Load(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		LOG_ERROR("Cannot open replay %s", path);
+		return false;
+	}
+
+	std::vector<uint8> data;
+	uint8 chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		data.insert(data.end(), chunk, chunk + read);
+	fclose(file);
+
+	const uint8* in = data.data();
+	const uint8* end = in + data.size();
+
+	uint32 magic = 0;
+	uint64 version, tick_rate, substeps, toi_budget, contact_solver = 0, count, size;
+	if (GetState(in, end, magic) == false || magic != REPLAY_MAGIC || GetVarint(in, end, version) == false || version < 2 || version > REPLAY_VERSION)
+	{
+		LOG_ERROR("%s is not a replay of this version", path);
+		return false;
+	}
+
+	bool ok = GetVarint(in, end, tick_rate) && GetVarint(in, end, substeps) && end - in >= 2;
+	if (ok)
+	{
+		settings.tick_rate = (int)tick_rate;
+		settings.substeps = (int)substeps;
+		settings.adaptive_iterations = *in++ != 0;
+		settings.ball_bullet = *in++ != 0;
+		ok = GetVarint(in, end, toi_budget) && in < end;
+	}
+	if (ok)
+	{
+		settings.toi_budget = (int)toi_budget;
+		settings.bake_playfield = *in++ != 0;
+		ok = GetState(in, end, settings.chain_tolerance) && (version < 3 || GetVarint(in, end, contact_solver))
+			&& GetVarint(in, end, frame_count) && GetVarint(in, end, size) && (uint64)(end - in) >= size;
+		settings.contact_solver = (int)contact_solver;
+	}
+	if (ok && contact_solver > b2_contactSolverWidePlain)
+	{
+		LOG_ERROR("%s is not a replay of this version", path);
+		return false;
+	}
+	if (ok)
+	{
+		frames.assign(in, in + size);
+		in += size;
+		ok = GetVarint(in, end, count) && (uint64)(end - in) >= count * sizeof(uint32);
+	}
+	if (ok)
+	{
+		hashes.resize((size_t)count);
+		for (uint32& hash : hashes)
+			GetState(in, end, hash);
+		ok = GetVarint(in, end, count);
+	}
+	for (uint64 i = 0; ok && i < count; ++i)
+	{
+		ReplayKeyframe keyframe;
+		uint64 key_offset;
+		ok = GetVarint(in, end, keyframe.frame) && GetVarint(in, end, keyframe.tick) && GetVarint(in, end, key_offset)
+			&& GetFrame(in, end, keyframe.previous) && GetVarint(in, end, size) && (uint64)(end - in) >= size;
+		if (ok)
+		{
+			keyframe.offset = (size_t)key_offset;
+			keyframe.state.assign(in, in + size);
+			in += size;
+			keyframes.push_back(std::move(keyframe));
+		}
+	}
+
+	if (ok == false)
+	{
+		LOG_ERROR("Replay %s is truncated", path);
+		return false;
+	}
+
+	offset = 0;
+	frame = 0;
+	previous = empty_frame;
+	run_left = 0;
+
+	return true;
+}
+
+bool ReplayReader::NextFrame(ReplayFrame& out)
+{
+	if (frame >= frame_count)
+		return false;
+
+	if (run_left > 0)
+	{
+		--run_left;
+		++frame;
+		out = previous;
+		return true;
+	}
+
+	const uint8* in = frames.data() + offset;
+	const uint8* end = frames.data() + frames.size();
+	if (in == end)
+		return false;
+
+	uint8 tag = *in++;
+	ReplayFrame next = previous;
+	uint64 value;
+
+	next.ticks = tag & TAG_TICKS_MASK;
+	if (next.ticks == TAG_TICKS_MASK && GetVarint(in, end, value)) next.ticks += (int)value;
+
+	if (tag & TAG_RUN)
+	{
+		GetVarint(in, end, value);
+		run_left = (int)value - 1;
+	}
+	if ((tag & TAG_CONTROLS) && in < end) next.controls = UnpackControls(*in++);
+	if ((tag & TAG_BUTTONS) && GetVarint(in, end, value)) next.buttons = (uint32)value;
+	if (tag & TAG_MOUSE)
+	{
+		if (GetVarint(in, end, value)) next.mouse_x = (int)(previous.mouse_x + UnZigZag(value));
+		if (GetVarint(in, end, value)) next.mouse_y = (int)(previous.mouse_y + UnZigZag(value));
+	}
+
+	offset = in - frames.data();
+	previous = next;
+	++frame;
+	out = next;
+	return true;
+}
+
+const ReplayKeyframe* ReplayReader::Seek(uint64 tick)
+{
+	const ReplayKeyframe* found = NULL;
+	for (const ReplayKeyframe& keyframe : keyframes)
+	{
+		if (keyframe.tick <= tick) found = &keyframe;
+	}
+
+	if (found != NULL)
+	{
+		offset = found->offset;
+		frame = found->frame;
+		previous = found->previous;
+		run_left = 0;
+	}
+
+	return found;
+}
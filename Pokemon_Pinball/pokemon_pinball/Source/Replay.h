@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Globals.h"
+#include "ModuleInput.h"
+#include "StateBuffer.h"
+
+#include <vector>
+
+#define REPLAY_MAGIC				0x50524250	// "PBRP"
+#define REPLAY_VERSION				3
+#define REPLAY_KEYFRAME_INTERVAL	600			// Ticks between keyframes
+#define REPLAY_FILE					"session.pbr"
+
+// Simulation settings that change the outcome, a replay applies them before Start
+struct ReplaySettings
+{
+	int tick_rate;
+	int substeps;
+	bool adaptive_iterations;
+	bool ball_bullet;
+	int toi_budget;
+	bool bake_playfield;
+	float chain_tolerance;
+	int contact_solver;		// b2ContactSolverMode, version 2 files always used the default one
+};
+
+// One frame as the simulation consumed it
+struct ReplayFrame
+{
+	int ticks;			// Physics ticks the frame stepped
+	TickInput controls;
+	uint32 buttons;		// GameButton bits held
+	int mouse_x;
+	int mouse_y;
+};
+
+// A point decoding can restart from, with the state to restore there
+struct ReplayKeyframe
+{
+	uint64 frame;		// Frames recorded before it
+	uint64 tick;		// Ticks stepped before it
+	size_t offset;		// Into the encoded frame stream
+	ReplayFrame previous;	// Frames are stored as changes against the one before
+	std::vector<uint8> state;
+};
+
+// Frame stream: one tag byte per frame, bits 0-2 the tick count (7 = more follow
+// as a varint), bit 3 controls changed, bit 4 buttons changed, bit 5 mouse moved
+// and bit 6 a varint repeat count for a run of frames with no change at all.
+// Changed values follow the tag, mouse moves as zigzag varint deltas.
+// Tick hashes are raw 32 bit values, one per tick.
+class ReplayWriter
+{
+public:
+	ReplayWriter();
+
+	void Begin(const ReplaySettings& settings);
+	void AddFrame(const ReplayFrame& frame);
+	void AddTickHash(uint32 hash) { hashes.push_back(hash); }
+	// At a frame boundary, before that frame is added
+	void AddKeyframe(std::vector<uint8>& state);
+	bool Save(const char* path);
+
+	uint64 GetFrameCount() const { return frame_count; }
+	uint64 GetTickCount() const { return tick_count; }
+
+private:
+	void FlushRun();
+
+	ReplaySettings settings;
+	std::vector<uint8> frames;
+	std::vector<uint32> hashes;
+	std::vector<ReplayKeyframe> keyframes;
+	ReplayFrame previous;
+	uint64 frame_count;
+	uint64 tick_count;
+
+	// Frames that only stepped run_ticks, not written until something changes
+	int run_length;
+	int run_ticks;
+};
+
+class ReplayReader
+{
+public:
+	ReplayReader();
+
+	bool Load(const char* path);
+	const ReplaySettings& GetSettings() const { return settings; }
+
+	// False once every recorded frame was read
+	bool NextFrame(ReplayFrame& frame);
+	// Last keyframe at or before tick, decoding continues from it. NULL when there is none
+	const ReplayKeyframe* Seek(uint64 tick);
+
+	uint64 GetFrameCount() const { return frame_count; }
+	uint64 GetTickCount() const { return hashes.size(); }
+	uint32 GetTickHash(uint64 tick) const { return (tick < hashes.size()) ? hashes[(size_t)tick] : 0; }
+	size_t GetEncodedSize() const { return frames.size(); }
+
+private:
+	ReplaySettings settings;
+	std::vector<uint8> frames;
+	std::vector<uint32> hashes;
+	std::vector<ReplayKeyframe> keyframes;
+	uint64 frame_count;
+
+	size_t offset;
+	uint64 frame;
+	ReplayFrame previous;
+	int run_left;		// Repeats of previous still to hand out
+};
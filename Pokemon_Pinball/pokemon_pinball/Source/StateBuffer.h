@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <string.h>
+#include <vector>
+
+// Raw copies for snapshots and replay keyframes, written and read back by the same build
+
+template<typename T>
+void PutState(std::vector<uint8>& out, const T& value)
+{
+	const uint8* bytes = (const uint8*)&value;
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+bool GetState(const uint8*& in, const uint8* end, T& value)
+{
+	if ((size_t)(end - in) < sizeof(T)) return false;
+	memcpy(&value, in, sizeof(T));
+	in += sizeof(T);
+	return true;
+}
@@ -1,11 +1,17 @@
 // ----------------------------------------------------
-// j1Timer.cpp
-// Fast timer with milisecons precision
+// Timer.cpp
+// Nanosecond timer on the steady clock and named accumulators
 // ----------------------------------------------------
 
 #include "Timer.h"
 
-#include "raylib.h"
+#include <chrono>
+#include <mutex>
+#include <string.h>
+
+static TimerAccumulator accumulators[MAX_TIMER_ACCUMULATORS];
+static std::atomic<int> accumulator_count(0);
+static std::mutex accumulator_mutex;
 
 Timer::Timer()
 {
@@ -14,10 +20,113 @@ Timer::Timer()
 
 void Timer::Start()
 {
-	started_at = GetTime();
+	started_at = GetTicks();
 }
 
 double Timer::ReadSec() const
 {
-	return (GetTime() - started_at);
-}
\ No newline at end of file
+	return (GetTicks() - started_at) / 1000000000.0;
+}
+
+double Timer::ReadMs() const
+{
+	return (GetTicks() - started_at) / 1000000.0;
+}
+
+double Timer::ReadUs() const
+{
+	return (GetTicks() - started_at) / 1000.0;
+}
+
+uint64 Timer::ReadTicks() const
+{
+	return GetTicks() - started_at;
+}
+
+uint64 Timer::GetTicks()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TimerAccumulator::Add(uint64 ticks)
+{
+	total_ticks.fetch_add(ticks, std::memory_order_relaxed);
+	calls.fetch_add(1, std::memory_order_relaxed);
+
+	uint64 current_max = max_ticks.load(std::memory_order_relaxed);
+	while (ticks > current_max && max_ticks.compare_exchange_weak(current_max, ticks, std::memory_order_relaxed) == false) {}
+}
+
+double TimerAccumulator::TotalMs() const
+{
+	return total_ticks.load(std::memory_order_relaxed) / 1000000.0;
+}
+
+double TimerAccumulator::AverageUs() const
+{
+	uint64 count = calls.load(std::memory_order_relaxed);
+	return (count > 0) ? total_ticks.load(std::memory_order_relaxed) / 1000.0 / count : 0.0;
+}
+
+double TimerAccumulator::MaxUs() const
+{
+	return max_ticks.load(std::memory_order_relaxed) / 1000.0;
+}
+
+TimerAccumulator* TimerAccumulator::Get(const char* name)
+{
+	std::lock_guard<std::mutex> lock(accumulator_mutex);
+
+	int count = accumulator_count.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i)
+	{
+		if (strcmp(accumulators[i].name, name) == 0) return &accumulators[i];
+	}
+
+	if (count == MAX_TIMER_ACCUMULATORS)
+	{
+		LOG_WARNING("Too many timer accumulators, ignoring %s", name);
+		return NULL;
+	}
+
+	TimerAccumulator* accumulator = &accumulators[count];
+	accumulator->name = name;
+	accumulator->total_ticks = 0;
+	accumulator->max_ticks = 0;
+	accumulator->calls = 0;
+
+	// Publish after the slot is filled so Count/At never see a half built entry
+	accumulator_count.store(count + 1, std::memory_order_release);
+
+	return accumulator;
+}
+
+int TimerAccumulator::Count()
+{
+	return accumulator_count.load(std::memory_order_acquire);
+}
+
+const TimerAccumulator& TimerAccumulator::At(int index)
+{
+	return accumulators[index];
+}
+
+void TimerAccumulator::ResetAll()
+{
+	for (int i = 0; i < Count(); ++i)
+	{
+		accumulators[i].total_ticks = 0;
+		accumulators[i].max_ticks = 0;
+		accumulators[i].calls = 0;
+	}
+}
+
+void TimerAccumulator::LogAll()
+{
+	for (int i = 0; i < Count(); ++i)
+	{
+		const TimerAccumulator& acc = accumulators[i];
+		LOG("%s: %llu calls, %.3f ms total, %.2f us avg, %.2f us max", acc.name,
+			(unsigned long long)acc.calls.load(), acc.TotalMs(), acc.AverageUs(), acc.MaxUs());
+	}
+}
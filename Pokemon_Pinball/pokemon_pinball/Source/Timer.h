@@ -1,8 +1,21 @@
 #pragma once
 
 #include "Globals.h"
-#include "Timer.h"
 
+#include <atomic>
+
+#define MAX_TIMER_ACCUMULATORS 64
+
+#define TIMER_CONCAT_INNER(a, b) a##b
+#define TIMER_CONCAT(a, b) TIMER_CONCAT_INNER(a, b)
+
+// Add the time spent in the enclosing scope to the accumulator called name.
+// The lookup happens once per call site, so it is cheap enough for hot paths
+#define SCOPED_TIMER(name) \
+	static TimerAccumulator* TIMER_CONCAT(timer_accumulator_, __LINE__) = TimerAccumulator::Get(name); \
+	ScopedTimer TIMER_CONCAT(scoped_timer_, __LINE__)(TIMER_CONCAT(timer_accumulator_, __LINE__))
+
+// Monotonic nanosecond timer, works before InitWindow and in headless tools
 class Timer
 {
 public:
@@ -12,9 +25,55 @@ public:
 
 	void Start();
 	double ReadSec() const;
+	double ReadMs() const;
+	double ReadUs() const;
+	uint64 ReadTicks() const;
+
+	// Nanoseconds on the steady clock
+	static uint64 GetTicks();
+
+private:
+
+	// Start time in ticks
+	uint64 started_at;
+};
+
+// Running totals shared by every SCOPED_TIMER with the same name, safe to feed from any thread
+struct TimerAccumulator
+{
+	const char* name;
+	std::atomic<uint64> total_ticks;
+	std::atomic<uint64> max_ticks;
+	std::atomic<uint64> calls;
+
+	void Add(uint64 ticks);
+	double TotalMs() const;
+	double AverageUs() const;
+	double MaxUs() const;
+
+	// Returns NULL once MAX_TIMER_ACCUMULATORS names are in use
+	static TimerAccumulator* Get(const char* name);
+	static int Count();
+	static const TimerAccumulator& At(int index);
+
+	static void ResetAll();
+	static void LogAll();
+};
+
+class ScopedTimer
+{
+public:
+
+	ScopedTimer(TimerAccumulator* accumulator) : accumulator(accumulator), start(Timer::GetTicks())
+	{}
+
+	~ScopedTimer()
+	{
+		if (accumulator != NULL) accumulator->Add(Timer::GetTicks() - start);
+	}
 
 private:
 
-    // Start time in seconds
-	double started_at;   
-};
\ No newline at end of file
+	TimerAccumulator* accumulator;
+	uint64 start;
+};
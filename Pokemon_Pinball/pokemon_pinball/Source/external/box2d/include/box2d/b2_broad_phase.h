@@ -108,6 +108,25 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Set the user data of a proxy, for state restored from a buffer.
+	void SetUserData(int32 proxyId, void* userData);
+
+	/// Size in bytes of the broad-phase state: the tree and the pending moves.
+	int32 GetStateSize() const;
+
+	/// Copy the broad-phase state into buffer. Returns the bytes written.
+	int32 SaveState(void* buffer) const;
+
+	/// Restore a state written by SaveState. Returns the bytes read.
+	int32 LoadState(const void* buffer);
+
+	/// Size of the state written by SaveState at the start of buffer, or -1 if it is
+	/// cut short or out of range. See b2DynamicTree::CheckState.
+	static int32 CheckState(const void* buffer, int32 size, int32* proxyCount, int32* nodeCapacity);
+
+	/// Is proxyId a proxy of a state that passed CheckState.
+	static bool IsStateProxy(const void* buffer, int32 proxyId);
+
 private:
 
 	friend class b2DynamicTree;
@@ -230,6 +249,11 @@ inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) cons
 	m_tree.RayCast(callback, input);
 }
 
+inline void b2BroadPhase::SetUserData(int32 proxyId, void* userData)
+{
+	m_tree.SetUserData(proxyId, userData);
+}
+
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_tree.ShiftOrigin(newOrigin);
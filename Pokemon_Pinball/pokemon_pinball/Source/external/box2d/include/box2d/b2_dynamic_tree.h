@@ -133,6 +133,28 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Set the user data of a proxy, for state restored from a buffer.
+	void SetUserData(int32 proxyId, void* userData);
+
+	/// Size in bytes of the tree state, the whole node pool.
+	int32 GetStateSize() const;
+
+	/// Copy the node pool and free list into buffer. Returns the bytes written.
+	int32 SaveState(void* buffer) const;
+
+	/// Restore a state written by SaveState, resizing the node pool to match. Proxy
+	/// ids stay the same but user data pointers must be set again with SetUserData.
+	/// Returns the bytes read.
+	int32 LoadState(const void* buffer);
+
+	/// Size of the state written by SaveState at the start of buffer, or -1 if it does not
+	/// fit in size bytes or its nodes do not form a tree and a free list. Also returns the
+	/// node capacity and the number of leaves.
+	static int32 CheckState(const void* buffer, int32 size, int32* nodeCapacity, int32* leafCount);
+
+	/// Is proxyId a leaf of a state that passed CheckState.
+	static bool IsStateLeaf(const void* buffer, int32 proxyId);
+
 private:
 
 	int32 AllocateNode();
@@ -166,6 +188,12 @@ inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 	return m_nodes[proxyId].userData;
 }
 
+inline void b2DynamicTree::SetUserData(int32 proxyId, void* userData)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].userData = userData;
+}
+
 inline bool b2DynamicTree::WasMoved(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
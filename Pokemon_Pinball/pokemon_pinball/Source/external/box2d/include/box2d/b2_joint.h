@@ -174,6 +174,12 @@ protected:
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(const b2SolverData& data) = 0;
 
+	// Warm starting impulses plus the motor, limit and target settings, for
+	// b2World::SaveState. Joint types without an override have no saved state.
+	virtual int32 GetStateSize() const { return 0; }
+	virtual void SaveState(void* buffer) const { B2_NOT_USED(buffer); }
+	virtual void LoadState(const void* buffer) { B2_NOT_USED(buffer); }
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
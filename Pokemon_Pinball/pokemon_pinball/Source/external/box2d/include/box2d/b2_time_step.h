@@ -38,6 +38,38 @@ struct B2_API b2Profile
 	float solveTOI;
 };
 
+/// Continuous collision work done by the last step.
+struct B2_API b2TOIStats
+{
+	int32 events;			///< contacts found to impact during the step
+	int32 subSteps;			///< TOI events solved, one island sub-step each
+	bool budgetExhausted;	///< the step stopped solving TOI events at the budget
+	int32 heldBodies;		///< bodies stopped at an impact left over by the budget
+};
+
+/// How the contact solver runs the velocity iterations.
+enum b2ContactSolverMode
+{
+	/// One contact at a time, two point manifolds with the block solver.
+	b2_contactSolverDefault,
+
+	/// Contacts are colored so no two of a color move the same body, then solved in
+	/// batches of b2GetWideContactLanes() at once with SIMD. The points of a manifold
+	/// are solved one after the other. The order differs, so do the results. Islands
+	/// with fewer contacts than lanes keep the default solver.
+	b2_contactSolverWide,
+
+	/// The wide solver on plain floats, one lane after the other. Same results as
+	/// b2_contactSolverWide, this is what it runs on when there is no SIMD.
+	b2_contactSolverWidePlain
+};
+
+/// Contacts solved at once by b2_contactSolverWide.
+B2_API int32 b2GetWideContactLanes();
+
+/// Instruction set used by b2_contactSolverWide, "plain" without SIMD.
+B2_API const char* b2GetWideContactInstructions();
+
 /// This is an internal structure.
 struct B2_API b2TimeStep
 {
@@ -47,6 +79,7 @@ struct B2_API b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	b2ContactSolverMode contactSolver;
 };
 
 /// This is an internal structure.
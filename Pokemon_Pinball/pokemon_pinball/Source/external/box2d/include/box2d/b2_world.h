@@ -34,6 +34,7 @@
 struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
+struct b2IslandBatch;
 struct b2JointDef;
 class b2Body;
 class b2Draw;
@@ -71,6 +72,11 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task executor to solve islands on several threads, nullptr to solve
+	/// them on the calling thread. The executor is owned by you and must remain in scope.
+	/// @warning this should be called outside of a time step.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -162,6 +168,14 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Limit the TOI sub-steps solved per step, 0 means no limit. When the budget runs
+	/// out, dynamic bodies with impacts left stop at their first one for the rest of the
+	/// step, keeping their velocity, and the next step solves the contact. This is
+	/// coarser than a TOI sub-step: a body pushed by a solved impact into one that was
+	/// never found can still tunnel, so check for it when choosing a budget.
+	void SetTOIBudget(int32 subSteps) { m_toiBudget = subSteps; }
+	int32 GetTOIBudget() const { return m_toiBudget; }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -210,6 +224,37 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the continuous collision counters of the last step.
+	const b2TOIStats& GetTOIStats() const { return m_toiStats; }
+
+	/// Get the number of islands solved in the last step.
+	int32 GetIslandCount() const { return m_islandCount; }
+
+	/// Choose how contacts are solved, b2_contactSolverDefault unless set.
+	void SetContactSolver(b2ContactSolverMode mode) { m_contactSolver = mode; }
+	b2ContactSolverMode GetContactSolver() const { return m_contactSolver; }
+
+	/// Size in bytes of the buffer SaveState needs for the world as it is now.
+	int32 GetStateSize() const;
+
+	/// Copy the simulation state into buffer: body motion, sleep and enabled flags,
+	/// fixture proxies, joint impulses, contacts with their manifolds and the broad-phase.
+	/// Loading it back into the same world (same bodies, fixtures and joints, created in
+	/// the same order) continues bit for bit like the world it was saved from. Mouse joints
+	/// follow the pointer rather than the simulation and are left out of the state.
+	/// @warning this should be called outside of a time step.
+	void SaveState(void* buffer) const;
+
+	/// Restore a state written by SaveState. No contact listener callbacks are made.
+	/// The whole buffer is checked before anything is restored. Returns false, leaving the
+	/// world untouched, if it was saved from a world with different bodies, fixtures or
+	/// joints, is not exactly size bytes or names a fixture, child or proxy out of range.
+	/// @warning this should be called outside of a time step.
+	bool LoadState(const void* buffer, int32 size);
+
+	/// Number of contacts in a state written by SaveState, or -1 if size is too small to tell.
+	static int32 GetStateContactCount(const void* buffer, int32 size);
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
@@ -222,13 +267,21 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step, b2IslandBatch* batch);
 	void SolveTOI(const b2TimeStep& step);
+	void HoldTOIBodies();
+	bool CheckState(const void* buffer, int32 size, b2Body** bodies);
 
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// Islands solved by the executor, one stack allocator per task.
+	b2TaskExecutor* m_taskExecutor;
+	b2StackAllocator* m_taskAllocators;
+	int32 m_taskCount;
+
 	b2ContactManager m_contactManager;
 
 	b2Body* m_bodyList;
@@ -255,10 +308,14 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	int32 m_toiBudget;
+	b2ContactSolverMode m_contactSolver;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+	b2TOIStats m_toiStats;
+	int32 m_islandCount;
 };
 
 inline b2Body* b2World::GetBodyList()
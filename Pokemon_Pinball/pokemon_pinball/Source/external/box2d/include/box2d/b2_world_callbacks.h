@@ -158,4 +158,24 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// Task callback for b2TaskExecutor.
+typedef void b2TaskFunction(int32 index, void* context);
+
+/// Implement this class on top of your job system to solve islands on several threads.
+/// Islands are independent, so the result is the same as solving them on one thread.
+/// Note: with an executor PostSolve is called for all islands after they are all solved,
+/// still in island order. It must not change bodies or the next islands see the change.
+class B2_API b2TaskExecutor
+{
+public:
+	virtual ~b2TaskExecutor() {}
+
+	/// The most tasks Run is asked for at once. The world keeps a stack allocator per task.
+	virtual int32 GetTaskCount() const = 0;
+
+	/// Call task(index, context) for every index in [0, count) and return once they are
+	/// all done. Tasks may run on any thread and in any order.
+	virtual void Run(int32 count, b2TaskFunction* task, void* context) = 0;
+};
+
 #endif
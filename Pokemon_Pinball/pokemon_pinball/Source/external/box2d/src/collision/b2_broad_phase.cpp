@@ -129,3 +129,92 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+int32 b2BroadPhase::GetStateSize() const
+{
+	return 2 * sizeof(int32) + m_moveCount * sizeof(int32) + m_tree.GetStateSize();
+}
+
+int32 b2BroadPhase::SaveState(void* buffer) const
+{
+	uint8* out = (uint8*)buffer;
+	memcpy(out, &m_proxyCount, sizeof(int32));
+	memcpy(out + sizeof(int32), &m_moveCount, sizeof(int32));
+	out += 2 * sizeof(int32);
+	memcpy(out, m_moveBuffer, m_moveCount * sizeof(int32));
+	out += m_moveCount * sizeof(int32);
+	out += m_tree.SaveState(out);
+
+	return int32(out - (uint8*)buffer);
+}
+
+int32 b2BroadPhase::LoadState(const void* buffer)
+{
+	const uint8* in = (const uint8*)buffer;
+	memcpy(&m_proxyCount, in, sizeof(int32));
+	memcpy(&m_moveCount, in + sizeof(int32), sizeof(int32));
+	in += 2 * sizeof(int32);
+
+	if (m_moveCount > m_moveCapacity)
+	{
+		b2Free(m_moveBuffer);
+		m_moveCapacity = m_moveCount;
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	}
+
+	memcpy(m_moveBuffer, in, m_moveCount * sizeof(int32));
+	in += m_moveCount * sizeof(int32);
+	in += m_tree.LoadState(in);
+
+	return int32(in - (const uint8*)buffer);
+}
+
+int32 b2BroadPhase::CheckState(const void* buffer, int32 size, int32* proxyCount, int32* nodeCapacity)
+{
+	if (size < 2 * (int32)sizeof(int32))
+	{
+		return -1;
+	}
+
+	const uint8* in = (const uint8*)buffer;
+
+	int32 moveCount;
+	memcpy(proxyCount, in, sizeof(int32));
+	memcpy(&moveCount, in + sizeof(int32), sizeof(int32));
+	in += 2 * sizeof(int32);
+	size -= 2 * sizeof(int32);
+
+	if (moveCount < 0 || moveCount > size / (int32)sizeof(int32))
+	{
+		return -1;
+	}
+
+	int32 moveSize = moveCount * (int32)sizeof(int32);
+	int32 leafCount = 0;
+	int32 treeSize = b2DynamicTree::CheckState(in + moveSize, size - moveSize, nodeCapacity, &leafCount);
+	if (treeSize < 0 || *proxyCount != leafCount)
+	{
+		return -1;
+	}
+
+	for (int32 i = 0; i < moveCount; ++i)
+	{
+		int32 proxyId;
+		memcpy(&proxyId, in + i * sizeof(int32), sizeof(int32));
+		if (proxyId != e_nullProxy && b2DynamicTree::IsStateLeaf(in + moveSize, proxyId) == false)
+		{
+			return -1;
+		}
+	}
+
+	return 2 * sizeof(int32) + moveSize + treeSize;
+}
+
+bool b2BroadPhase::IsStateProxy(const void* buffer, int32 proxyId)
+{
+	const uint8* in = (const uint8*)buffer;
+
+	int32 moveCount;
+	memcpy(&moveCount, in + sizeof(int32), sizeof(int32));
+	return b2DynamicTree::IsStateLeaf(in + 2 * sizeof(int32) + moveCount * sizeof(int32), proxyId);
+}
@@ -799,3 +799,192 @@ void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
 }
+
+struct b2TreeState
+{
+	int32 root;
+	int32 nodeCount;
+	int32 nodeCapacity;
+	int32 freeList;
+	int32 insertionCount;
+};
+
+int32 b2DynamicTree::GetStateSize() const
+{
+	return sizeof(b2TreeState) + m_nodeCapacity * sizeof(b2TreeNode);
+}
+
+int32 b2DynamicTree::SaveState(void* buffer) const
+{
+	b2TreeState state;
+	state.root = m_root;
+	state.nodeCount = m_nodeCount;
+	state.nodeCapacity = m_nodeCapacity;
+	state.freeList = m_freeList;
+	state.insertionCount = m_insertionCount;
+
+	uint8* out = (uint8*)buffer;
+	memcpy(out, &state, sizeof(state));
+	memcpy(out + sizeof(state), m_nodes, m_nodeCapacity * sizeof(b2TreeNode));
+
+	return GetStateSize();
+}
+
+int32 b2DynamicTree::LoadState(const void* buffer)
+{
+	const uint8* in = (const uint8*)buffer;
+
+	b2TreeState state;
+	memcpy(&state, in, sizeof(state));
+
+	// Same capacity as when saved, so the pool grows at the same point again
+	if (state.nodeCapacity != m_nodeCapacity)
+	{
+		b2Free(m_nodes);
+		m_nodeCapacity = state.nodeCapacity;
+		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	}
+
+	memcpy(m_nodes, in + sizeof(state), m_nodeCapacity * sizeof(b2TreeNode));
+	m_root = state.root;
+	m_nodeCount = state.nodeCount;
+	m_freeList = state.freeList;
+	m_insertionCount = state.insertionCount;
+
+	return GetStateSize();
+}
+
+static void b2ReadStateNode(const uint8* nodes, int32 index, b2TreeNode* node)
+{
+	memcpy(node, nodes + index * sizeof(b2TreeNode), sizeof(b2TreeNode));
+}
+
+int32 b2DynamicTree::CheckState(const void* buffer, int32 size, int32* nodeCapacity, int32* leafCount)
+{
+	if (size < (int32)sizeof(b2TreeState))
+	{
+		return -1;
+	}
+
+	b2TreeState state;
+	memcpy(&state, buffer, sizeof(state));
+	const uint8* nodes = (const uint8*)buffer + sizeof(state);
+
+	// An empty pool would never grow again
+	int32 capacity = state.nodeCapacity;
+	if (capacity <= 0 || capacity > (size - (int32)sizeof(b2TreeState)) / (int32)sizeof(b2TreeNode) ||
+		state.nodeCount < 0 || state.nodeCount > capacity ||
+		state.root < b2_nullNode || state.root >= capacity || (state.root == b2_nullNode) != (state.nodeCount == 0))
+	{
+		return -1;
+	}
+
+	// Every live node hangs off the root through parents of greater height, so walking
+	// up or down the tree always ends. Free nodes only use their next link.
+	int32 liveCount = 0;
+	int32 leaves = 0;
+	for (int32 i = 0; i < capacity; ++i)
+	{
+		b2TreeNode node;
+		b2ReadStateNode(nodes, i, &node);
+		if (node.height < 0)
+		{
+			continue;
+		}
+
+		++liveCount;
+
+		if (node.parent == b2_nullNode)
+		{
+			if (i != state.root)
+			{
+				return -1;
+			}
+		}
+		else
+		{
+			if (node.parent < 0 || node.parent >= capacity)
+			{
+				return -1;
+			}
+
+			b2TreeNode parent;
+			b2ReadStateNode(nodes, node.parent, &parent);
+			if (parent.height <= node.height || (parent.child1 != i && parent.child2 != i))
+			{
+				return -1;
+			}
+		}
+
+		if (node.child1 == b2_nullNode)
+		{
+			if (node.child2 != b2_nullNode || node.height != 0)
+			{
+				return -1;
+			}
+			++leaves;
+			continue;
+		}
+
+		if (node.child1 < 0 || node.child1 >= capacity || node.child2 < 0 || node.child2 >= capacity ||
+			node.child1 == node.child2)
+		{
+			return -1;
+		}
+
+		b2TreeNode child1, child2;
+		b2ReadStateNode(nodes, node.child1, &child1);
+		b2ReadStateNode(nodes, node.child2, &child2);
+		if (child1.height < 0 || child2.height < 0 || child1.parent != i || child2.parent != i ||
+			node.height != 1 + b2Max(child1.height, child2.height))
+		{
+			return -1;
+		}
+	}
+
+	if (liveCount != state.nodeCount)
+	{
+		return -1;
+	}
+
+	// The free list holds every other node exactly once
+	int32 freeCount = 0;
+	for (int32 i = state.freeList; i != b2_nullNode; )
+	{
+		if (i < 0 || i >= capacity || ++freeCount > capacity - state.nodeCount)
+		{
+			return -1;
+		}
+
+		b2TreeNode node;
+		b2ReadStateNode(nodes, i, &node);
+		if (node.height >= 0)
+		{
+			return -1;
+		}
+		i = node.next;
+	}
+
+	if (freeCount != capacity - state.nodeCount)
+	{
+		return -1;
+	}
+
+	*nodeCapacity = capacity;
+	*leafCount = leaves;
+	return sizeof(b2TreeState) + capacity * sizeof(b2TreeNode);
+}
+
+bool b2DynamicTree::IsStateLeaf(const void* buffer, int32 proxyId)
+{
+	b2TreeState state;
+	memcpy(&state, buffer, sizeof(state));
+	if (proxyId < 0 || proxyId >= state.nodeCapacity)
+	{
+		return false;
+	}
+
+	b2TreeNode node;
+	b2ReadStateNode((const uint8*)buffer + sizeof(state), proxyId, &node);
+	return node.height == 0;
+}
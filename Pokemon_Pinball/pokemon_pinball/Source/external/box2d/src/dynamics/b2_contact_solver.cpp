@@ -28,6 +28,27 @@
 #include "box2d/b2_stack_allocator.h"
 #include "box2d/b2_world.h"
 
+#include <stdint.h>
+#include <string.h>
+
+// Lanes and instruction set of the wide solver, SIMD builds solve the same batches as plain ones.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define B2_WIDE_LANES 8
+#define B2_WIDE_INSTRUCTIONS "AVX2"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define B2_WIDE_LANES 4
+#define B2_WIDE_INSTRUCTIONS "SSE2"
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define B2_WIDE_LANES 4
+#define B2_WIDE_INSTRUCTIONS "NEON"
+#else
+#define B2_WIDE_LANES 4
+#define B2_WIDE_INSTRUCTIONS "plain"
+#endif
+
 // Solver debugging is normally disabled because the block solver sometimes has to deal with a poorly conditioned effective mass matrix.
 #define B2_DEBUG_SOLVER 0
 
@@ -48,6 +69,319 @@ struct b2ContactPositionConstraint
 	int32 pointCount;
 };
 
+// Wide solver data: B2_WIDE_LANES contacts in SoA layout. Lanes with fewer points than
+// the batch have zero masses for the others, empty lanes a constraint index of -1.
+struct b2WideContactPoint
+{
+	float rAx[B2_WIDE_LANES];
+	float rAy[B2_WIDE_LANES];
+	float rBx[B2_WIDE_LANES];
+	float rBy[B2_WIDE_LANES];
+	float normalMass[B2_WIDE_LANES];
+	float tangentMass[B2_WIDE_LANES];
+	float velocityBias[B2_WIDE_LANES];
+	float normalImpulse[B2_WIDE_LANES];
+	float tangentImpulse[B2_WIDE_LANES];
+};
+
+struct alignas(32) b2WideContactConstraint
+{
+	b2WideContactPoint points[b2_maxManifoldPoints];
+	float normalX[B2_WIDE_LANES];
+	float normalY[B2_WIDE_LANES];
+	float invMassA[B2_WIDE_LANES];
+	float invIA[B2_WIDE_LANES];
+	float invMassB[B2_WIDE_LANES];
+	float invIB[B2_WIDE_LANES];
+	float friction[B2_WIDE_LANES];
+	float tangentSpeed[B2_WIDE_LANES];
+	int32 indexA[B2_WIDE_LANES];
+	int32 indexB[B2_WIDE_LANES];
+	int32 constraintIndex[B2_WIDE_LANES];
+	int32 pointCount;
+};
+
+// Contacts that find no free color among these are solved in a batch of their own.
+const int32 b2_wideColorCount = 12;
+
+// Plain lanes. Min and max pick like b2Min and b2Max, and like the SIMD versions.
+struct b2FloatP
+{
+	float v[B2_WIDE_LANES];
+
+	static b2FloatP Load(const float* p)
+	{
+		b2FloatP r;
+		for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = p[i];
+		return r;
+	}
+
+	void Store(float* p) const
+	{
+		for (int32 i = 0; i < B2_WIDE_LANES; ++i) p[i] = v[i];
+	}
+};
+
+inline b2FloatP operator+(const b2FloatP& a, const b2FloatP& b)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = a.v[i] + b.v[i];
+	return r;
+}
+
+inline b2FloatP operator-(const b2FloatP& a, const b2FloatP& b)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = a.v[i] - b.v[i];
+	return r;
+}
+
+inline b2FloatP operator*(const b2FloatP& a, const b2FloatP& b)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = a.v[i] * b.v[i];
+	return r;
+}
+
+inline b2FloatP operator-(const b2FloatP& a)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = -a.v[i];
+	return r;
+}
+
+inline b2FloatP b2MinW(const b2FloatP& a, const b2FloatP& b)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+	return r;
+}
+
+inline b2FloatP b2MaxW(const b2FloatP& a, const b2FloatP& b)
+{
+	b2FloatP r;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+	return r;
+}
+
+#if defined(__AVX2__)
+
+struct b2FloatW
+{
+	__m256 v;
+
+	static b2FloatW Load(const float* p) { b2FloatW r = { _mm256_load_ps(p) }; return r; }
+	void Store(float* p) const { _mm256_store_ps(p, v); }
+};
+
+inline b2FloatW operator+(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm256_add_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm256_sub_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator*(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm256_mul_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a) { b2FloatW r = { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; return r; }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm256_min_ps(a.v, b.v) }; return r; }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm256_max_ps(a.v, b.v) }; return r; }
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+struct b2FloatW
+{
+	__m128 v;
+
+	static b2FloatW Load(const float* p) { b2FloatW r = { _mm_load_ps(p) }; return r; }
+	void Store(float* p) const { _mm_store_ps(p, v); }
+};
+
+inline b2FloatW operator+(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm_add_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm_sub_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator*(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm_mul_ps(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a) { b2FloatW r = { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; return r; }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm_min_ps(a.v, b.v) }; return r; }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { b2FloatW r = { _mm_max_ps(a.v, b.v) }; return r; }
+
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+
+struct b2FloatW
+{
+	float32x4_t v;
+
+	static b2FloatW Load(const float* p) { b2FloatW r = { vld1q_f32(p) }; return r; }
+	void Store(float* p) const { vst1q_f32(p, v); }
+};
+
+inline b2FloatW operator+(b2FloatW a, b2FloatW b) { b2FloatW r = { vaddq_f32(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a, b2FloatW b) { b2FloatW r = { vsubq_f32(a.v, b.v) }; return r; }
+inline b2FloatW operator*(b2FloatW a, b2FloatW b) { b2FloatW r = { vmulq_f32(a.v, b.v) }; return r; }
+inline b2FloatW operator-(b2FloatW a) { b2FloatW r = { vnegq_f32(a.v) }; return r; }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { b2FloatW r = { vbslq_f32(vcltq_f32(a.v, b.v), a.v, b.v) }; return r; }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { b2FloatW r = { vbslq_f32(vcgtq_f32(a.v, b.v), a.v, b.v) }; return r; }
+
+#else
+
+typedef b2FloatP b2FloatW;
+
+#endif
+
+int32 b2GetWideContactLanes()
+{
+	return B2_WIDE_LANES;
+}
+
+const char* b2GetWideContactInstructions()
+{
+	return B2_WIDE_INSTRUCTIONS;
+}
+
+// One batch of SolveVelocityConstraints. No two lanes move the same body, so they
+// can all be solved at once. Friction first, then the normal of each point in turn.
+template <typename V>
+static void b2SolveWideContact(b2WideContactConstraint* c, b2Velocity* velocities)
+{
+	struct alignas(32) b2BodyLanes
+	{
+		float vx[B2_WIDE_LANES];
+		float vy[B2_WIDE_LANES];
+		float w[B2_WIDE_LANES];
+	};
+
+	b2BodyLanes bodyA, bodyB;
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i)
+	{
+		if (c->constraintIndex[i] < 0)
+		{
+			bodyA.vx[i] = bodyA.vy[i] = bodyA.w[i] = 0.0f;
+			bodyB.vx[i] = bodyB.vy[i] = bodyB.w[i] = 0.0f;
+			continue;
+		}
+
+		const b2Velocity& vA = velocities[c->indexA[i]];
+		const b2Velocity& vB = velocities[c->indexB[i]];
+		bodyA.vx[i] = vA.v.x;
+		bodyA.vy[i] = vA.v.y;
+		bodyA.w[i] = vA.w;
+		bodyB.vx[i] = vB.v.x;
+		bodyB.vy[i] = vB.v.y;
+		bodyB.w[i] = vB.w;
+	}
+
+	V vAx = V::Load(bodyA.vx);
+	V vAy = V::Load(bodyA.vy);
+	V wA = V::Load(bodyA.w);
+	V vBx = V::Load(bodyB.vx);
+	V vBy = V::Load(bodyB.vy);
+	V wB = V::Load(bodyB.w);
+
+	V mA = V::Load(c->invMassA);
+	V iA = V::Load(c->invIA);
+	V mB = V::Load(c->invMassB);
+	V iB = V::Load(c->invIB);
+
+	V nx = V::Load(c->normalX);
+	V ny = V::Load(c->normalY);
+	V tx = ny;
+	V ty = -nx;
+	V friction = V::Load(c->friction);
+	V tangentSpeed = V::Load(c->tangentSpeed);
+
+	int32 pointCount = c->pointCount;
+
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2WideContactPoint* cp = c->points + j;
+		V rAx = V::Load(cp->rAx);
+		V rAy = V::Load(cp->rAy);
+		V rBx = V::Load(cp->rBx);
+		V rBy = V::Load(cp->rBy);
+
+		// Relative velocity at contact
+		V dvx = vBx - wB * rBy - vAx + wA * rAy;
+		V dvy = vBy + wB * rBx - vAy - wA * rAx;
+
+		// Compute tangent force
+		V vt = dvx * tx + dvy * ty - tangentSpeed;
+		V lambda = V::Load(cp->tangentMass) * (-vt);
+
+		// Clamp the accumulated force
+		V maxFriction = friction * V::Load(cp->normalImpulse);
+		V oldImpulse = V::Load(cp->tangentImpulse);
+		V newImpulse = b2MaxW(-maxFriction, b2MinW(oldImpulse + lambda, maxFriction));
+		lambda = newImpulse - oldImpulse;
+		newImpulse.Store(cp->tangentImpulse);
+
+		// Apply contact impulse
+		V Px = lambda * tx;
+		V Py = lambda * ty;
+
+		vAx = vAx - mA * Px;
+		vAy = vAy - mA * Py;
+		wA = wA - iA * (rAx * Py - rAy * Px);
+
+		vBx = vBx + mB * Px;
+		vBy = vBy + mB * Py;
+		wB = wB + iB * (rBx * Py - rBy * Px);
+	}
+
+	V zero = V::Load(c->points[0].rAx);
+	zero = zero - zero;
+
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2WideContactPoint* cp = c->points + j;
+		V rAx = V::Load(cp->rAx);
+		V rAy = V::Load(cp->rAy);
+		V rBx = V::Load(cp->rBx);
+		V rBy = V::Load(cp->rBy);
+
+		// Relative velocity at contact
+		V dvx = vBx - wB * rBy - vAx + wA * rAy;
+		V dvy = vBy + wB * rBx - vAy - wA * rAx;
+
+		// Compute normal impulse
+		V vn = dvx * nx + dvy * ny;
+		V lambda = -V::Load(cp->normalMass) * (vn - V::Load(cp->velocityBias));
+
+		// Clamp the accumulated impulse
+		V oldImpulse = V::Load(cp->normalImpulse);
+		V newImpulse = b2MaxW(oldImpulse + lambda, zero);
+		lambda = newImpulse - oldImpulse;
+		newImpulse.Store(cp->normalImpulse);
+
+		// Apply contact impulse
+		V Px = lambda * nx;
+		V Py = lambda * ny;
+
+		vAx = vAx - mA * Px;
+		vAy = vAy - mA * Py;
+		wA = wA - iA * (rAx * Py - rAy * Px);
+
+		vBx = vBx + mB * Px;
+		vBy = vBy + mB * Py;
+		wB = wB + iB * (rBx * Py - rBy * Px);
+	}
+
+	vAx.Store(bodyA.vx);
+	vAy.Store(bodyA.vy);
+	wA.Store(bodyA.w);
+	vBx.Store(bodyB.vx);
+	vBy.Store(bodyB.vy);
+	wB.Store(bodyB.w);
+
+	// In lane order: lanes only share bodies that do not move, written back unchanged
+	for (int32 i = 0; i < B2_WIDE_LANES; ++i)
+	{
+		if (c->constraintIndex[i] < 0)
+		{
+			continue;
+		}
+
+		b2Velocity& vA = velocities[c->indexA[i]];
+		b2Velocity& vB = velocities[c->indexB[i]];
+		vA.v.Set(bodyA.vx[i], bodyA.vy[i]);
+		vA.w = bodyA.w[i];
+		vB.v.Set(bodyB.vx[i], bodyB.vy[i]);
+		vB.w = bodyB.w[i];
+	}
+}
+
 b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 {
 	m_step = def->step;
@@ -58,6 +392,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_wideConstraints = nullptr;
+	m_wideCount = 0;
+	m_wideMemory = nullptr;
+	m_colorMemory = nullptr;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -138,6 +476,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_wideMemory != nullptr)
+	{
+		m_allocator->Free(m_wideMemory);
+		m_allocator->Free(m_colorMemory);
+	}
+
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -252,6 +596,133 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	// Fewer contacts than lanes would only fill batches with empty lanes
+	if (m_step.contactSolver != b2_contactSolverDefault && m_wideMemory == nullptr && m_count >= B2_WIDE_LANES)
+	{
+		PrepareWideConstraints();
+	}
+}
+
+// Greedy coloring in contact order: a contact takes the first color that none of the
+// bodies it moves has yet. Each color is then packed into batches, in contact order.
+void b2ContactSolver::PrepareWideConstraints()
+{
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bodyCount = b2Max(bodyCount, b2Max(vc->indexA, vc->indexB) + 1);
+	}
+
+	m_colorMemory = m_allocator->Allocate(bodyCount * sizeof(uint32) + m_count * sizeof(int32));
+	uint32* bodyColors = (uint32*)m_colorMemory;
+	int32* colors = (int32*)(bodyColors + bodyCount);
+	memset(bodyColors, 0, bodyCount * sizeof(uint32));
+
+	// The last count is for contacts left without a color
+	int32 colorCounts[b2_wideColorCount + 1] = { 0 };
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+		// Bodies that do not move can be in any number of lanes
+		bool movesA = vc->invMassA > 0.0f || vc->invIA > 0.0f;
+		bool movesB = vc->invMassB > 0.0f || vc->invIB > 0.0f;
+		uint32 used = (movesA ? bodyColors[vc->indexA] : 0) | (movesB ? bodyColors[vc->indexB] : 0);
+
+		int32 color = 0;
+		while (color < b2_wideColorCount && (used & (1u << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color < b2_wideColorCount)
+		{
+			if (movesA) bodyColors[vc->indexA] |= 1u << color;
+			if (movesB) bodyColors[vc->indexB] |= 1u << color;
+		}
+
+		colors[i] = color;
+		++colorCounts[color];
+	}
+
+	m_wideCount = colorCounts[b2_wideColorCount];
+	for (int32 color = 0; color < b2_wideColorCount; ++color)
+	{
+		m_wideCount += (colorCounts[color] + B2_WIDE_LANES - 1) / B2_WIDE_LANES;
+	}
+
+	int32 size = m_wideCount * (int32)sizeof(b2WideContactConstraint);
+	m_wideMemory = m_allocator->Allocate(size + 32);
+	m_wideConstraints = (b2WideContactConstraint*)(((uintptr_t)m_wideMemory + 31) & ~(uintptr_t)31);
+	memset(m_wideConstraints, 0, size);
+
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		for (int32 lane = 0; lane < B2_WIDE_LANES; ++lane)
+		{
+			m_wideConstraints[i].constraintIndex[lane] = -1;
+		}
+	}
+
+	b2WideContactConstraint* wc = m_wideConstraints;
+	int32 lane = 0;
+	for (int32 color = 0; color <= b2_wideColorCount; ++color)
+	{
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			if (colors[i] != color)
+			{
+				continue;
+			}
+
+			const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+			wc->normalX[lane] = vc->normal.x;
+			wc->normalY[lane] = vc->normal.y;
+			wc->invMassA[lane] = vc->invMassA;
+			wc->invIA[lane] = vc->invIA;
+			wc->invMassB[lane] = vc->invMassB;
+			wc->invIB[lane] = vc->invIB;
+			wc->friction[lane] = vc->friction;
+			wc->tangentSpeed[lane] = vc->tangentSpeed;
+			wc->indexA[lane] = vc->indexA;
+			wc->indexB[lane] = vc->indexB;
+			wc->constraintIndex[lane] = i;
+			wc->pointCount = b2Max(wc->pointCount, vc->pointCount);
+
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				const b2VelocityConstraintPoint* vcp = vc->points + j;
+				b2WideContactPoint* cp = wc->points + j;
+				cp->rAx[lane] = vcp->rA.x;
+				cp->rAy[lane] = vcp->rA.y;
+				cp->rBx[lane] = vcp->rB.x;
+				cp->rBy[lane] = vcp->rB.y;
+				cp->normalMass[lane] = vcp->normalMass;
+				cp->tangentMass[lane] = vcp->tangentMass;
+				cp->velocityBias[lane] = vcp->velocityBias;
+				cp->normalImpulse[lane] = vcp->normalImpulse;
+				cp->tangentImpulse[lane] = vcp->tangentImpulse;
+			}
+
+			// Contacts without a color share no batch
+			if (++lane == B2_WIDE_LANES || color == b2_wideColorCount)
+			{
+				++wc;
+				lane = 0;
+			}
+		}
+
+		if (lane > 0)
+		{
+			++wc;
+			lane = 0;
+		}
+	}
+
+	b2Assert(wc == m_wideConstraints + m_wideCount);
 }
 
 void b2ContactSolver::WarmStart()
@@ -294,8 +765,31 @@ void b2ContactSolver::WarmStart()
 	}
 }
 
+void b2ContactSolver::SolveWideVelocityConstraints()
+{
+	if (m_step.contactSolver == b2_contactSolverWidePlain)
+	{
+		for (int32 i = 0; i < m_wideCount; ++i)
+		{
+			b2SolveWideContact<b2FloatP>(m_wideConstraints + i, m_velocities);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		b2SolveWideContact<b2FloatW>(m_wideConstraints + i, m_velocities);
+	}
+}
+
 void b2ContactSolver::SolveVelocityConstraints()
 {
+	if (m_wideConstraints != nullptr)
+	{
+		SolveWideVelocityConstraints();
+		return;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -608,6 +1102,26 @@ void b2ContactSolver::SolveVelocityConstraints()
 
 void b2ContactSolver::StoreImpulses()
 {
+	// Back from the wide batches first, Report reads them from the velocity constraints
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		const b2WideContactConstraint* wc = m_wideConstraints + i;
+		for (int32 lane = 0; lane < B2_WIDE_LANES; ++lane)
+		{
+			if (wc->constraintIndex[lane] < 0)
+			{
+				continue;
+			}
+
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + wc->constraintIndex[lane];
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = wc->points[j].normalImpulse[lane];
+				vc->points[j].tangentImpulse = wc->points[j].tangentImpulse[lane];
+			}
+		}
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -31,6 +31,7 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2WideContactConstraint;
 
 struct b2VelocityConstraintPoint
 {
@@ -86,6 +87,9 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	void PrepareWideConstraints();
+	void SolveWideVelocityConstraints();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -94,6 +98,12 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	// Colored batches for b2_contactSolverWide, nullptr when the default solver runs.
+	b2WideContactConstraint* m_wideConstraints;
+	int32 m_wideCount;
+	void* m_wideMemory;
+	void* m_colorMemory;
 };
 
 #endif
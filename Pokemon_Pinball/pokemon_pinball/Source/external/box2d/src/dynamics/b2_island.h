@@ -31,15 +31,18 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
 /// This is an internal class.
+/// Islands solved at the same time share their static bodies. These are only read:
+/// b2World gives each one a fixed index below staticSlotCount, the same in every island.
 class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener, int32 staticSlotCount = 0);
 	~b2Island();
 
 	void Clear()
@@ -47,6 +50,7 @@ public:
 		m_bodyCount = 0;
 		m_contactCount = 0;
 		m_jointCount = 0;
+		m_indexCount = 0;
 	}
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
@@ -56,7 +60,10 @@ public:
 	void Add(b2Body* body)
 	{
 		b2Assert(m_bodyCount < m_bodyCapacity);
-		body->m_islandIndex = m_bodyCount;
+		if (m_staticSlotCount == 0 || body->m_type != b2_staticBody)
+		{
+			body->m_islandIndex = m_staticSlotCount + m_indexCount++;
+		}
 		m_bodies[m_bodyCount] = body;
 		++m_bodyCount;
 	}
@@ -78,6 +85,9 @@ public:
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// When set, Report stores the impulses here for b2World to pass on later.
+	b2ContactImpulse* m_impulses;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
@@ -89,6 +99,9 @@ public:
 	int32 m_jointCount;
 	int32 m_contactCount;
 
+	int32 m_staticSlotCount;
+	int32 m_indexCount;
+
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
@@ -25,6 +25,8 @@
 #include "box2d/b2_prismatic_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Linear constraint (point-to-line)
 // d = p2 - p1 = x2 + r2 - x1 - r1
 // C = dot(perp, d)
@@ -641,3 +643,54 @@ void b2PrismaticJoint::Draw(b2Draw* draw) const
 	draw->DrawPoint(pA, 5.0f, c1);
 	draw->DrawPoint(pB, 5.0f, c4);
 }
+
+struct b2PrismaticJointState
+{
+	b2Vec2 impulse;
+	float motorImpulse;
+	float lowerImpulse;
+	float upperImpulse;
+	float lowerTranslation;
+	float upperTranslation;
+	float maxMotorForce;
+	float motorSpeed;
+	bool enableLimit;
+	bool enableMotor;
+};
+
+int32 b2PrismaticJoint::GetStateSize() const
+{
+	return sizeof(b2PrismaticJointState);
+}
+
+void b2PrismaticJoint::SaveState(void* buffer) const
+{
+	b2PrismaticJointState state;
+	state.impulse = m_impulse;
+	state.motorImpulse = m_motorImpulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	state.lowerTranslation = m_lowerTranslation;
+	state.upperTranslation = m_upperTranslation;
+	state.maxMotorForce = m_maxMotorForce;
+	state.motorSpeed = m_motorSpeed;
+	state.enableLimit = m_enableLimit;
+	state.enableMotor = m_enableMotor;
+	memcpy(buffer, &state, sizeof(state));
+}
+
+void b2PrismaticJoint::LoadState(const void* buffer)
+{
+	b2PrismaticJointState state;
+	memcpy(&state, buffer, sizeof(state));
+	m_impulse = state.impulse;
+	m_motorImpulse = state.motorImpulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+	m_lowerTranslation = state.lowerTranslation;
+	m_upperTranslation = state.upperTranslation;
+	m_maxMotorForce = state.maxMotorForce;
+	m_motorSpeed = state.motorSpeed;
+	m_enableLimit = state.enableLimit;
+	m_enableMotor = state.enableMotor;
+}
@@ -25,6 +25,8 @@
 #include "box2d/b2_revolute_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Point-to-point constraint
 // C = p2 - p1
 // Cdot = v2 - v1
@@ -499,3 +501,54 @@ void b2RevoluteJoint::Draw(b2Draw* draw) const
 	draw->DrawSegment(pA, pB, color);
 	draw->DrawSegment(xfB.p, pB, color);
 }
+
+struct b2RevoluteJointState
+{
+	b2Vec2 impulse;
+	float motorImpulse;
+	float lowerImpulse;
+	float upperImpulse;
+	float maxMotorTorque;
+	float motorSpeed;
+	float lowerAngle;
+	float upperAngle;
+	bool enableLimit;
+	bool enableMotor;
+};
+
+int32 b2RevoluteJoint::GetStateSize() const
+{
+	return sizeof(b2RevoluteJointState);
+}
+
+void b2RevoluteJoint::SaveState(void* buffer) const
+{
+	b2RevoluteJointState state;
+	state.impulse = m_impulse;
+	state.motorImpulse = m_motorImpulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	state.maxMotorTorque = m_maxMotorTorque;
+	state.motorSpeed = m_motorSpeed;
+	state.lowerAngle = m_lowerAngle;
+	state.upperAngle = m_upperAngle;
+	state.enableLimit = m_enableLimit;
+	state.enableMotor = m_enableMotor;
+	memcpy(buffer, &state, sizeof(state));
+}
+
+void b2RevoluteJoint::LoadState(const void* buffer)
+{
+	b2RevoluteJointState state;
+	memcpy(&state, buffer, sizeof(state));
+	m_impulse = state.impulse;
+	m_motorImpulse = state.motorImpulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+	m_maxMotorTorque = state.maxMotorTorque;
+	m_motorSpeed = state.motorSpeed;
+	m_lowerAngle = state.lowerAngle;
+	m_upperAngle = state.upperAngle;
+	m_enableLimit = state.enableLimit;
+	m_enableMotor = state.enableMotor;
+}
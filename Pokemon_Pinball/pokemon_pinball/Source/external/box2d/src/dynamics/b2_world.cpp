@@ -39,6 +39,7 @@
 #include "box2d/b2_world.h"
 
 #include <new>
+#include <string.h>
 
 b2World::b2World(const b2Vec2& gravity)
 {
@@ -54,6 +55,12 @@ b2World::b2World(const b2Vec2& gravity)
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_toiBudget = 0;
+	m_contactSolver = b2_contactSolverDefault;
+	m_toiStats.events = 0;
+	m_toiStats.subSteps = 0;
+	m_toiStats.budgetExhausted = false;
+	m_toiStats.heldBodies = 0;
 
 	m_stepComplete = true;
 
@@ -66,6 +73,11 @@ b2World::b2World(const b2Vec2& gravity)
 
 	m_inv_dt0 = 0.0f;
 
+	m_taskExecutor = nullptr;
+	m_taskAllocators = nullptr;
+	m_taskCount = 0;
+	m_islandCount = 0;
+
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
@@ -90,6 +102,8 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	SetTaskExecutor(nullptr);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -112,6 +126,31 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::SetTaskExecutor(b2TaskExecutor* executor)
+{
+	b2Assert(IsLocked() == false);
+
+	for (int32 i = 0; i < m_taskCount; ++i)
+	{
+		m_taskAllocators[i].~b2StackAllocator();
+	}
+	b2Free(m_taskAllocators);
+
+	m_taskExecutor = executor;
+	m_taskAllocators = nullptr;
+	m_taskCount = 0;
+
+	if (executor != nullptr)
+	{
+		m_taskCount = b2Max(executor->GetTaskCount(), 1);
+		m_taskAllocators = (b2StackAllocator*)b2Alloc(m_taskCount * sizeof(b2StackAllocator));
+		for (int32 i = 0; i < m_taskCount; ++i)
+		{
+			new (m_taskAllocators + i) b2StackAllocator;
+		}
+	}
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -390,12 +429,93 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// An island gathered for the task executor, as ranges of the batch lists.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	int32 task;
+	float solveInit;
+	float solveVelocity;
+	float solvePosition;
+};
+
+// The islands of a step, solved by b2SolveIslandTask.
+struct b2IslandBatch
+{
+	b2TimeStep step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	b2ContactListener* listener;
+	b2StackAllocator* allocators;
+	int32 staticSlotCount;
+
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2ContactImpulse* impulses;
+	b2IslandRange* islands;
+
+	int32 bodyCount;
+	int32 contactCount;
+	int32 jointCount;
+	int32 islandCount;
+};
+
+// Solves the islands given to one task, in order, with the task's stack allocator.
+static void b2SolveIslandTask(int32 index, void* context)
+{
+	b2IslandBatch* batch = (b2IslandBatch*)context;
+	b2StackAllocator* allocator = batch->allocators + index;
+
+	for (int32 i = 0; i < batch->islandCount; ++i)
+	{
+		b2IslandRange* range = batch->islands + i;
+		if (range->task != index)
+		{
+			continue;
+		}
+
+		b2Island island(range->bodyCount, range->contactCount, range->jointCount,
+						allocator, batch->listener, batch->staticSlotCount);
+
+		for (int32 j = 0; j < range->bodyCount; ++j)
+		{
+			island.Add(batch->bodies[range->bodyStart + j]);
+		}
+		for (int32 j = 0; j < range->contactCount; ++j)
+		{
+			island.Add(batch->contacts[range->contactStart + j]);
+		}
+		for (int32 j = 0; j < range->jointCount; ++j)
+		{
+			island.Add(batch->joints[range->jointStart + j]);
+		}
+
+		if (batch->impulses != nullptr)
+		{
+			island.m_impulses = batch->impulses + range->contactStart;
+		}
+
+		b2Profile profile;
+		island.Solve(&profile, batch->step, batch->gravity, batch->allowSleep);
+		range->solveInit = profile.solveInit;
+		range->solveVelocity = profile.solveVelocity;
+		range->solvePosition = profile.solvePosition;
+	}
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
 	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
+	m_islandCount = 0;
 
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
@@ -421,6 +541,23 @@ void b2World::Solve(const b2TimeStep& step)
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+
+	// With a task executor the islands are only gathered here and solved together after.
+	// Static bodies can be in several islands, the others are in one at most.
+	b2IslandBatch batch;
+	if (m_taskExecutor != nullptr)
+	{
+		int32 contactCount = m_contactManager.m_contactCount;
+		batch.bodies = (b2Body**)m_stackAllocator.Allocate((m_bodyCount + contactCount + m_jointCount) * sizeof(b2Body*));
+		batch.contacts = (b2Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b2Contact*));
+		batch.joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+		batch.islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+		batch.bodyCount = 0;
+		batch.contactCount = 0;
+		batch.jointCount = 0;
+		batch.islandCount = 0;
+	}
+
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
 		if (seed->m_flags & b2Body::e_islandFlag)
@@ -535,11 +672,33 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		++m_islandCount;
+
+		if (m_taskExecutor != nullptr)
+		{
+			b2IslandRange* range = batch.islands + batch.islandCount++;
+			range->bodyStart = batch.bodyCount;
+			range->bodyCount = island.m_bodyCount;
+			range->contactStart = batch.contactCount;
+			range->contactCount = island.m_contactCount;
+			range->jointStart = batch.jointCount;
+			range->jointCount = island.m_jointCount;
+
+			memcpy(batch.bodies + batch.bodyCount, island.m_bodies, island.m_bodyCount * sizeof(b2Body*));
+			memcpy(batch.contacts + batch.contactCount, island.m_contacts, island.m_contactCount * sizeof(b2Contact*));
+			memcpy(batch.joints + batch.jointCount, island.m_joints, island.m_jointCount * sizeof(b2Joint*));
+			batch.bodyCount += island.m_bodyCount;
+			batch.contactCount += island.m_contactCount;
+			batch.jointCount += island.m_jointCount;
+		}
+		else
+		{
+			b2Profile profile;
+			island.Solve(&profile, step, m_gravity, m_allowSleep);
+			m_profile.solveInit += profile.solveInit;
+			m_profile.solveVelocity += profile.solveVelocity;
+			m_profile.solvePosition += profile.solvePosition;
+		}
 
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -553,6 +712,16 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
+	if (m_taskExecutor != nullptr)
+	{
+		SolveIslands(step, &batch);
+
+		m_stackAllocator.Free(batch.islands);
+		m_stackAllocator.Free(batch.joints);
+		m_stackAllocator.Free(batch.contacts);
+		m_stackAllocator.Free(batch.bodies);
+	}
+
 	m_stackAllocator.Free(stack);
 
 	{
@@ -581,6 +750,98 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+// Solve the gathered islands on the task executor. Each island is solved by itself like
+// in Solve, so the result does not depend on the tasks. PostSolve follows in island order.
+void b2World::SolveIslands(const b2TimeStep& step, b2IslandBatch* batch)
+{
+	if (batch->islandCount == 0)
+	{
+		return;
+	}
+
+	// Shared static bodies get the same index in every island.
+	int32 staticSlotCount = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->m_type == b2_staticBody)
+		{
+			b->m_islandIndex = staticSlotCount++;
+		}
+	}
+
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+
+	batch->step = step;
+	batch->gravity = m_gravity;
+	batch->allowSleep = m_allowSleep;
+	batch->listener = listener;
+	batch->allocators = m_taskAllocators;
+	batch->staticSlotCount = staticSlotCount;
+	batch->impulses = nullptr;
+	if (listener != nullptr)
+	{
+		batch->impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(batch->contactCount * sizeof(b2ContactImpulse));
+	}
+
+	// Hand each island to the task with the least work so far.
+	int32 taskCount = b2Min(m_taskCount, batch->islandCount);
+	int32* loads = (int32*)m_stackAllocator.Allocate(taskCount * sizeof(int32));
+	for (int32 i = 0; i < taskCount; ++i)
+	{
+		loads[i] = 0;
+	}
+
+	for (int32 i = 0; i < batch->islandCount; ++i)
+	{
+		b2IslandRange* range = batch->islands + i;
+
+		int32 task = 0;
+		for (int32 j = 1; j < taskCount; ++j)
+		{
+			if (loads[j] < loads[task])
+			{
+				task = j;
+			}
+		}
+
+		range->task = task;
+		loads[task] += range->bodyCount + range->contactCount + range->jointCount;
+	}
+
+	if (taskCount == 1)
+	{
+		b2SolveIslandTask(0, batch);
+	}
+	else
+	{
+		m_taskExecutor->Run(taskCount, b2SolveIslandTask, batch);
+	}
+
+	for (int32 i = 0; i < batch->islandCount; ++i)
+	{
+		const b2IslandRange* range = batch->islands + i;
+		m_profile.solveInit += range->solveInit;
+		m_profile.solveVelocity += range->solveVelocity;
+		m_profile.solvePosition += range->solvePosition;
+
+		if (listener == nullptr)
+		{
+			continue;
+		}
+
+		for (int32 j = 0; j < range->contactCount; ++j)
+		{
+			listener->PostSolve(batch->contacts[range->contactStart + j], batch->impulses + range->contactStart + j);
+		}
+	}
+
+	m_stackAllocator.Free(loads);
+	if (batch->impulses != nullptr)
+	{
+		m_stackAllocator.Free(batch->impulses);
+	}
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
@@ -588,6 +849,11 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 	if (m_stepComplete)
 	{
+		m_toiStats.events = 0;
+		m_toiStats.subSteps = 0;
+		m_toiStats.budgetExhausted = false;
+		m_toiStats.heldBodies = 0;
+
 		for (b2Body* b = m_bodyList; b; b = b->m_next)
 		{
 			b->m_flags &= ~b2Body::e_islandFlag;
@@ -702,6 +968,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 				if (output.state == b2TOIOutput::e_touching)
 				{
 					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+					++m_toiStats.events;
 				}
 				else
 				{
@@ -727,6 +994,15 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 
+		// Out of budget: stop the bodies at the remaining impacts for the next step.
+		if (m_toiBudget > 0 && m_toiStats.subSteps >= m_toiBudget)
+		{
+			m_toiStats.budgetExhausted = true;
+			m_stepComplete = true;
+			HoldTOIBodies();
+			break;
+		}
+
 		// Advance the bodies to the TOI.
 		b2Fixture* fA = minContact->GetFixtureA();
 		b2Fixture* fB = minContact->GetFixtureB();
@@ -868,7 +1144,9 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.contactSolver = b2_contactSolverDefault;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+		++m_toiStats.subSteps;
 
 		// Reset island flags and synchronize broad-phase proxies.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -902,6 +1180,52 @@ void b2World::SolveTOI(const b2TimeStep& step)
 	}
 }
 
+// Ending the step at its full pose would leave a body past the surface it hits, and a
+// one-sided chain does not push it back. Earliest impacts go first, so a body hit twice
+// stops at the first. Velocities are untouched, the next step solves the contacts.
+void b2World::HoldTOIBodies()
+{
+	for (;;)
+	{
+		// Contacts still flagged have a valid TOI from the last pass of SolveTOI
+		b2Contact* minContact = nullptr;
+		float minAlpha = 1.0f;
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			if ((c->m_flags & b2Contact::e_toiFlag) && c->m_toi < minAlpha)
+			{
+				minContact = c;
+				minAlpha = c->m_toi;
+			}
+		}
+
+		if (minContact == nullptr || 1.0f - 10.0f * b2_epsilon < minAlpha)
+		{
+			break;
+		}
+
+		minContact->m_flags &= ~b2Contact::e_toiFlag;
+
+		b2Body* bodies[2] = {minContact->GetFixtureA()->GetBody(), minContact->GetFixtureB()->GetBody()};
+		for (int32 i = 0; i < 2; ++i)
+		{
+			b2Body* body = bodies[i];
+
+			// Kinematic bodies keep their path, bodies already held stay at the earlier impact
+			if (body->m_type != b2_dynamicBody || body->m_sweep.alpha0 >= minAlpha)
+			{
+				continue;
+			}
+
+			body->Advance(minAlpha);
+			body->SynchronizeFixtures();
+			++m_toiStats.heldBodies;
+		}
+	}
+
+	m_contactManager.FindNewContacts();
+}
+
 void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 {
 	b2Timer stepTimer;
@@ -931,6 +1255,7 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.contactSolver = m_contactSolver;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
@@ -1257,6 +1582,508 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
 }
 
+struct b2WorldStateHeader
+{
+	int32 bodyCount;
+	int32 jointCount;
+	int32 fixtureCount;
+	int32 contactCount;
+	int32 jointStateSize;
+	float inv_dt0;
+	bool newContacts;
+	bool stepComplete;
+};
+
+struct b2BodyState
+{
+	b2Transform xf;
+	b2Sweep sweep;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+	b2Vec2 force;
+	float torque;
+	float sleepTime;
+	uint16 flags;
+};
+
+struct b2FixtureProxyState
+{
+	b2AABB aabb;
+	int32 proxyId;
+};
+
+// Fixtures are named by the index of their body in the body list and their index in that body
+struct b2ContactState
+{
+	int32 bodyA, fixtureA, childA;
+	int32 bodyB, fixtureB, childB;
+	uint32 flags;
+	b2Manifold manifold;
+	int32 toiCount;
+	float toi;
+	float friction;
+	float restitution;
+	float restitutionThreshold;
+	float tangentSpeed;
+};
+
+static int32 b2FixtureIndex(const b2Fixture* fixture)
+{
+	int32 index = 0;
+	for (const b2Fixture* f = fixture->GetBody()->GetFixtureList(); f != fixture; f = f->GetNext())
+	{
+		++index;
+	}
+	return index;
+}
+
+static b2Fixture* b2FixtureAt(b2Body* body, int32 index)
+{
+	b2Fixture* fixture = body->GetFixtureList();
+	for (int32 i = 0; i < index && fixture; ++i)
+	{
+		fixture = fixture->GetNext();
+	}
+	return index >= 0 ? fixture : nullptr;
+}
+
+int32 b2World::GetStateSize() const
+{
+	int32 size = sizeof(b2WorldStateHeader) + m_bodyCount * sizeof(b2BodyState);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			size += sizeof(int32) + f->m_shape->GetChildCount() * sizeof(b2FixtureProxyState);
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_mouseJoint)
+		{
+			size += j->GetStateSize();
+		}
+	}
+
+	size += m_contactManager.m_contactCount * sizeof(b2ContactState);
+	size += m_contactManager.m_broadPhase.GetStateSize();
+	return size;
+}
+
+void b2World::SaveState(void* buffer) const
+{
+	b2Assert(IsLocked() == false);
+
+	uint8* out = (uint8*)buffer;
+
+	b2WorldStateHeader header;
+	header.bodyCount = m_bodyCount;
+	header.jointCount = 0;
+	header.fixtureCount = 0;
+	header.contactCount = m_contactManager.m_contactCount;
+	header.jointStateSize = 0;
+	header.inv_dt0 = m_inv_dt0;
+	header.newContacts = m_newContacts;
+	header.stepComplete = m_stepComplete;
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		header.fixtureCount += b->m_fixtureCount;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_mouseJoint)
+		{
+			++header.jointCount;
+			header.jointStateSize += j->GetStateSize();
+		}
+	}
+
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+	int32 bodyIndex = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		// The island index is scratch outside of Solve, contacts use it to name their bodies
+		b->m_islandIndex = bodyIndex++;
+
+		b2BodyState body;
+		body.xf = b->m_xf;
+		body.sweep = b->m_sweep;
+		body.linearVelocity = b->m_linearVelocity;
+		body.angularVelocity = b->m_angularVelocity;
+		body.force = b->m_force;
+		body.torque = b->m_torque;
+		body.sleepTime = b->m_sleepTime;
+		body.flags = b->m_flags;
+		memcpy(out, &body, sizeof(body));
+		out += sizeof(body);
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			memcpy(out, &f->m_proxyCount, sizeof(int32));
+			out += sizeof(int32);
+
+			int32 childCount = f->m_shape->GetChildCount();
+			for (int32 i = 0; i < childCount; ++i)
+			{
+				b2FixtureProxyState proxy;
+				proxy.aabb = f->m_proxies[i].aabb;
+				proxy.proxyId = f->m_proxies[i].proxyId;
+				memcpy(out, &proxy, sizeof(proxy));
+				out += sizeof(proxy);
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_mouseJoint)
+		{
+			j->SaveState(out);
+			out += j->GetStateSize();
+		}
+	}
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		b2ContactState contact;
+		contact.bodyA = c->m_fixtureA->m_body->m_islandIndex;
+		contact.fixtureA = b2FixtureIndex(c->m_fixtureA);
+		contact.childA = c->m_indexA;
+		contact.bodyB = c->m_fixtureB->m_body->m_islandIndex;
+		contact.fixtureB = b2FixtureIndex(c->m_fixtureB);
+		contact.childB = c->m_indexB;
+		contact.flags = c->m_flags;
+		contact.manifold = c->m_manifold;
+		contact.toiCount = c->m_toiCount;
+		contact.toi = c->m_toi;
+		contact.friction = c->m_friction;
+		contact.restitution = c->m_restitution;
+		contact.restitutionThreshold = c->m_restitutionThreshold;
+		contact.tangentSpeed = c->m_tangentSpeed;
+		memcpy(out, &contact, sizeof(contact));
+		out += sizeof(contact);
+	}
+
+	m_contactManager.m_broadPhase.SaveState(out);
+}
+
+bool b2World::LoadState(const void* buffer, int32 size)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || size < (int32)sizeof(b2WorldStateHeader))
+	{
+		return false;
+	}
+
+	const uint8* in = (const uint8*)buffer;
+
+	b2WorldStateHeader header;
+	memcpy(&header, in, sizeof(header));
+	in += sizeof(header);
+
+	int32 fixtureCount = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		fixtureCount += b->m_fixtureCount;
+	}
+	int32 jointCount = 0;
+	int32 jointStateSize = 0;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_mouseJoint)
+		{
+			++jointCount;
+			jointStateSize += j->GetStateSize();
+		}
+	}
+
+	if (header.bodyCount != m_bodyCount || header.jointCount != jointCount ||
+		header.fixtureCount != fixtureCount || header.jointStateSize != jointStateSize)
+	{
+		return false;
+	}
+
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	if (CheckState(buffer, size, bodies) == false)
+	{
+		m_stackAllocator.Free(bodies);
+		return false;
+	}
+
+	// Contacts are rebuilt from the buffer, without any listener callbacks
+	b2Contact* c = m_contactManager.m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->m_next;
+		b2Contact::Destroy(c, &m_blockAllocator);
+		c = next;
+	}
+	m_contactManager.m_contactList = nullptr;
+	m_contactManager.m_contactCount = 0;
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_contactList = nullptr;
+
+		b2BodyState body;
+		memcpy(&body, in, sizeof(body));
+		in += sizeof(body);
+
+		b->m_xf = body.xf;
+		b->m_sweep = body.sweep;
+		b->m_linearVelocity = body.linearVelocity;
+		b->m_angularVelocity = body.angularVelocity;
+		b->m_force = body.force;
+		b->m_torque = body.torque;
+		b->m_sleepTime = body.sleepTime;
+		b->m_flags = body.flags;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			memcpy(&f->m_proxyCount, in, sizeof(int32));
+			in += sizeof(int32);
+
+			int32 childCount = f->m_shape->GetChildCount();
+			for (int32 i = 0; i < childCount; ++i)
+			{
+				b2FixtureProxyState proxy;
+				memcpy(&proxy, in, sizeof(proxy));
+				in += sizeof(proxy);
+
+				f->m_proxies[i].aabb = proxy.aabb;
+				f->m_proxies[i].proxyId = proxy.proxyId;
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_mouseJoint)
+		{
+			j->LoadState(in);
+			in += j->GetStateSize();
+		}
+	}
+
+	// Contacts and body edges are prepended on creation, creating them from the back of
+	// the saved list puts both back in their original order
+	const uint8* contacts = in;
+	in += header.contactCount * sizeof(b2ContactState);
+
+	for (int32 i = header.contactCount - 1; i >= 0; --i)
+	{
+		b2ContactState contact;
+		memcpy(&contact, contacts + i * sizeof(b2ContactState), sizeof(contact));
+
+		b2Fixture* fixtureA = b2FixtureAt(bodies[contact.bodyA], contact.fixtureA);
+		b2Fixture* fixtureB = b2FixtureAt(bodies[contact.bodyB], contact.fixtureB);
+
+		// Saved in the order the factory created them, it does not swap them again. The
+		// edges still follow the contact's own fixtures in case a buffer names them the other way
+		c = b2Contact::Create(fixtureA, contact.childA, fixtureB, contact.childB, &m_blockAllocator);
+		b2Body* bodyA = c->m_fixtureA->m_body;
+		b2Body* bodyB = c->m_fixtureB->m_body;
+
+		c->m_flags = contact.flags;
+		c->m_manifold = contact.manifold;
+		c->m_toiCount = contact.toiCount;
+		c->m_toi = contact.toi;
+		c->m_friction = contact.friction;
+		c->m_restitution = contact.restitution;
+		c->m_restitutionThreshold = contact.restitutionThreshold;
+		c->m_tangentSpeed = contact.tangentSpeed;
+
+		c->m_prev = nullptr;
+		c->m_next = m_contactManager.m_contactList;
+		if (m_contactManager.m_contactList != nullptr)
+		{
+			m_contactManager.m_contactList->m_prev = c;
+		}
+		m_contactManager.m_contactList = c;
+
+		c->m_nodeA.contact = c;
+		c->m_nodeA.other = bodyB;
+		c->m_nodeA.prev = nullptr;
+		c->m_nodeA.next = bodyA->m_contactList;
+		if (bodyA->m_contactList != nullptr)
+		{
+			bodyA->m_contactList->prev = &c->m_nodeA;
+		}
+		bodyA->m_contactList = &c->m_nodeA;
+
+		c->m_nodeB.contact = c;
+		c->m_nodeB.other = bodyA;
+		c->m_nodeB.prev = nullptr;
+		c->m_nodeB.next = bodyB->m_contactList;
+		if (bodyB->m_contactList != nullptr)
+		{
+			bodyB->m_contactList->prev = &c->m_nodeB;
+		}
+		bodyB->m_contactList = &c->m_nodeB;
+
+		++m_contactManager.m_contactCount;
+	}
+
+	m_stackAllocator.Free(bodies);
+
+	// Proxy ids are restored with the tree, the user data pointers are this world's own
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	in += broadPhase->LoadState(in);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				broadPhase->SetUserData(f->m_proxies[i].proxyId, f->m_proxies + i);
+			}
+		}
+	}
+
+	m_inv_dt0 = header.inv_dt0;
+	m_newContacts = header.newContacts;
+	m_stepComplete = header.stepComplete;
+
+	b2Assert(in - (const uint8*)buffer == size);
+	return true;
+}
+
+int32 b2World::GetStateContactCount(const void* buffer, int32 size)
+{
+	if (size < (int32)sizeof(b2WorldStateHeader))
+	{
+		return -1;
+	}
+
+	b2WorldStateHeader header;
+	memcpy(&header, buffer, sizeof(header));
+	return header.contactCount;
+}
+
+// Walks a state for LoadState without restoring any of it, the header counts were already
+// compared with this world. Fills bodies with the body list so contacts can be checked.
+bool b2World::CheckState(const void* buffer, int32 size, b2Body** bodies)
+{
+	const uint8* in = (const uint8*)buffer;
+
+	b2WorldStateHeader header;
+	memcpy(&header, in, sizeof(header));
+
+	// Everything up to the contacts has a size this world already knows
+	int32 offset = sizeof(b2WorldStateHeader) + m_bodyCount * sizeof(b2BodyState) + header.jointStateSize;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			offset += sizeof(int32) + f->m_shape->GetChildCount() * sizeof(b2FixtureProxyState);
+		}
+	}
+
+	if (offset > size || header.contactCount < 0 ||
+		header.contactCount > (size - offset) / (int32)sizeof(b2ContactState))
+	{
+		return false;
+	}
+
+	const uint8* contacts = in + offset;
+	offset += header.contactCount * sizeof(b2ContactState);
+
+	const uint8* broadPhase = in + offset;
+	int32 proxyCount = 0;
+	int32 nodeCapacity = 0;
+	int32 broadPhaseSize = b2BroadPhase::CheckState(broadPhase, size - offset, &proxyCount, &nodeCapacity);
+	if (broadPhaseSize < 0 || offset + broadPhaseSize != size)
+	{
+		return false;
+	}
+
+	// Each proxy is a leaf of its own, and every leaf gets a fixture's user data back
+	bool* used = (bool*)m_stackAllocator.Allocate(nodeCapacity * sizeof(bool));
+	memset(used, 0, nodeCapacity * sizeof(bool));
+	bool valid = true;
+
+	in += sizeof(header);
+
+	int32 bodyIndex = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		bodies[bodyIndex++] = b;
+		in += sizeof(b2BodyState);
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			int32 fixtureProxies;
+			memcpy(&fixtureProxies, in, sizeof(int32));
+			in += sizeof(int32);
+
+			int32 childCount = f->m_shape->GetChildCount();
+			if (fixtureProxies < 0 || fixtureProxies > childCount)
+			{
+				valid = false;
+			}
+
+			for (int32 i = 0; valid && i < fixtureProxies; ++i)
+			{
+				b2FixtureProxyState proxy;
+				memcpy(&proxy, in + i * sizeof(proxy), sizeof(proxy));
+				if (b2BroadPhase::IsStateProxy(broadPhase, proxy.proxyId) == false || used[proxy.proxyId])
+				{
+					valid = false;
+				}
+				else
+				{
+					used[proxy.proxyId] = true;
+					--proxyCount;
+				}
+			}
+			in += childCount * sizeof(b2FixtureProxyState);
+		}
+	}
+
+	m_stackAllocator.Free(used);
+	if (valid == false || proxyCount != 0)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < header.contactCount; ++i)
+	{
+		b2ContactState contact;
+		memcpy(&contact, contacts + i * sizeof(b2ContactState), sizeof(contact));
+
+		if (contact.bodyA < 0 || contact.bodyA >= m_bodyCount || contact.bodyB < 0 || contact.bodyB >= m_bodyCount)
+		{
+			return false;
+		}
+
+		const b2Fixture* fixtureA = b2FixtureAt(bodies[contact.bodyA], contact.fixtureA);
+		const b2Fixture* fixtureB = b2FixtureAt(bodies[contact.bodyB], contact.fixtureB);
+		if (fixtureA == nullptr || fixtureB == nullptr ||
+			contact.childA < 0 || contact.childA >= fixtureA->m_shape->GetChildCount() ||
+			contact.childB < 0 || contact.childB >= fixtureB->m_shape->GetChildCount() ||
+			contact.manifold.pointCount < 0 || contact.manifold.pointCount > b2_maxManifoldPoints)
+		{
+			return false;
+		}
+
+		// The contact factory has nothing for edges and chains touching each other
+		b2Shape::Type typeA = fixtureA->GetType();
+		b2Shape::Type typeB = fixtureB->GetType();
+		if ((typeA == b2Shape::e_edge || typeA == b2Shape::e_chain) && (typeB == b2Shape::e_edge || typeB == b2Shape::e_chain))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void b2World::Dump()
 {
 	if (m_locked)
@@ -127,9 +127,9 @@ public:
 		return(*this);
 	}
 
-	vec2<TYPE>& operator*(float a)
+	vec2<TYPE> operator*(float a) const
 	{
-		p2Vector<TYPE> r;
+		vec2<TYPE> r;
 
 		r.x = x * a;
 		r.y = y * a;